@@ -0,0 +1,254 @@
+// Filename: DDS.c
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+
+// DDS wavetable engine. TIM16 runs a fixed DDS_CARRIER_HZ PWM carrier (PSC = 0, ARR = DDS_ARR) and
+// TIM6 interrupts at the sample rate. Each sample adds every voice's phase increment to its 32-bit phase
+// accumulator, looks up the wavetable with the top 8 bits, scales it by the voice's envelope gain,
+// sums the voices with saturation and writes the duty to CCR1. Every sample_rate / ENV_CONTROL_HZ
+// samples the same interrupt steps the ADSR envelopes (ENVELOPE.c); note on/off commands are applied
+// at the very next sample. The CCR1 preload (OC1PE) makes
+// the new duty start on a carrier period boundary. The tone frequency is set by the increment:
+// increment = frequency * 2^32 / sample_rate.
+
+#include "DDS.h"
+
+const int16_t DDS_SINE[256] = {
+         0,    804,   1608,   2410,   3212,   4011,   4808,   5602,   6393,   7179,   7962,   8739,   9512,  10278,  11039,  11793,
+     12539,  13279,  14010,  14732,  15446,  16151,  16846,  17530,  18204,  18868,  19519,  20159,  20787,  21403,  22005,  22594,
+     23170,  23731,  24279,  24811,  25329,  25832,  26319,  26790,  27245,  27683,  28105,  28510,  28898,  29268,  29621,  29956,
+     30273,  30571,  30852,  31113,  31356,  31580,  31785,  31971,  32137,  32285,  32412,  32521,  32609,  32678,  32728,  32757,
+     32767,  32757,  32728,  32678,  32609,  32521,  32412,  32285,  32137,  31971,  31785,  31580,  31356,  31113,  30852,  30571,
+     30273,  29956,  29621,  29268,  28898,  28510,  28105,  27683,  27245,  26790,  26319,  25832,  25329,  24811,  24279,  23731,
+     23170,  22594,  22005,  21403,  20787,  20159,  19519,  18868,  18204,  17530,  16846,  16151,  15446,  14732,  14010,  13279,
+     12539,  11793,  11039,  10278,   9512,   8739,   7962,   7179,   6393,   5602,   4808,   4011,   3212,   2410,   1608,    804,
+         0,   -804,  -1608,  -2410,  -3212,  -4011,  -4808,  -5602,  -6393,  -7179,  -7962,  -8739,  -9512, -10278, -11039, -11793,
+    -12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530, -18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
+    -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790, -27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956,
+    -30273, -30571, -30852, -31113, -31356, -31580, -31785, -31971, -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+    -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285, -32137, -31971, -31785, -31580, -31356, -31113, -30852, -30571,
+    -30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683, -27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731,
+    -23170, -22594, -22005, -21403, -20787, -20159, -19519, -18868, -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+    -12539, -11793, -11039, -10278,  -9512,  -8739,  -7962,  -7179,  -6393,  -5602,  -4808,  -4011,  -3212,  -2410,  -1608,   -804,
+};
+
+const int16_t DDS_TRIANGLE[256] = {
+         0,    511,   1023,   1535,   2047,   2559,   3071,   3583,   4095,   4607,   5119,   5631,   6143,   6655,   7167,   7679,
+      8191,   8703,   9215,   9727,  10239,  10751,  11263,  11775,  12287,  12799,  13311,  13823,  14335,  14847,  15359,  15871,
+     16383,  16895,  17407,  17919,  18431,  18943,  19455,  19967,  20479,  20991,  21503,  22015,  22527,  23039,  23551,  24063,
+     24575,  25087,  25599,  26111,  26623,  27135,  27647,  28159,  28671,  29183,  29695,  30207,  30719,  31231,  31743,  32255,
+     32767,  32256,  31744,  31232,  30720,  30208,  29696,  29184,  28672,  28160,  27648,  27136,  26624,  26112,  25600,  25088,
+     24576,  24064,  23552,  23040,  22528,  22016,  21504,  20992,  20480,  19968,  19456,  18944,  18432,  17920,  17408,  16896,
+     16384,  15872,  15360,  14848,  14336,  13824,  13312,  12800,  12288,  11776,  11264,  10752,  10240,   9728,   9216,   8704,
+      8192,   7680,   7168,   6656,   6144,   5632,   5120,   4608,   4096,   3584,   3072,   2560,   2048,   1536,   1024,    512,
+         0,   -511,  -1023,  -1535,  -2047,  -2559,  -3071,  -3583,  -4095,  -4607,  -5119,  -5631,  -6143,  -6655,  -7167,  -7679,
+     -8191,  -8703,  -9215,  -9727, -10239, -10751, -11263, -11775, -12287, -12799, -13311, -13823, -14335, -14847, -15359, -15871,
+    -16383, -16895, -17407, -17919, -18431, -18943, -19455, -19967, -20479, -20991, -21503, -22015, -22527, -23039, -23551, -24063,
+    -24575, -25087, -25599, -26111, -26623, -27135, -27647, -28159, -28671, -29183, -29695, -30207, -30719, -31231, -31743, -32255,
+    -32767, -32256, -31744, -31232, -30720, -30208, -29696, -29184, -28672, -28160, -27648, -27136, -26624, -26112, -25600, -25088,
+    -24576, -24064, -23552, -23040, -22528, -22016, -21504, -20992, -20480, -19968, -19456, -18944, -18432, -17920, -17408, -16896,
+    -16384, -15872, -15360, -14848, -14336, -13824, -13312, -12800, -12288, -11776, -11264, -10752, -10240,  -9728,  -9216,  -8704,
+     -8192,  -7680,  -7168,  -6656,  -6144,  -5632,  -5120,  -4608,  -4096,  -3584,  -3072,  -2560,  -2048,  -1536,  -1024,   -512,
+};
+
+const int16_t DDS_SQUARE[256] = {
+     32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,
+     32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,
+     32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,
+     32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,
+     32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,
+     32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,
+     32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,
+     32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,  32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+    -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767, -32767,
+};
+
+// Settings and state shared with the sample interrupt
+static const int16_t * volatile wave = DDS_SINE;
+// Voices are kept as parallel arrays so the mix loop walks them in order
+static uint32_t phase[DDS_VOICES];               // position in the waveform cycle, 2^32 = one full cycle
+static volatile uint32_t increment[DDS_VOICES];  // phase step per sample, 0 = voice off
+
+// Envelopes, owned by the interrupt. DDS_voice() only posts a command that the next sample applies.
+#define VOICE_NO_CHANGE 0
+#define VOICE_NOTE_ON   1
+#define VOICE_NOTE_OFF  2
+static const instrument organ = INSTRUMENT_ORGAN;
+static env_state env[DDS_VOICES];
+static const instrument * volatile voice_instrument[DDS_VOICES];
+static volatile uint8_t command[DDS_VOICES];
+static volatile uint32_t next_increment[DDS_VOICES];
+static volatile uint8_t commands_pending = 0; // set after a command is posted, cleared by the interrupt
+static uint32_t control_div = 1;  // samples per envelope tick
+static uint32_t control_count = 1;
+static uint32_t rate = 0;               // samples per second
+
+// Per-sample cost (DWT cycles inside the handler)
+static volatile uint32_t max_cycles = 0;
+static volatile uint64_t total_cycles = 0;
+static volatile uint32_t samples = 0;
+
+void init_DDS(uint32_t sample_rate){
+    rate = sample_rate;
+    for (int v = 0; v < DDS_VOICES; v++) {
+        phase[v] = 0;
+        increment[v] = 0;
+        command[v] = VOICE_NO_CHANGE;
+        env[v].stage = ENV_IDLE;
+        env[v].level = 0;
+        if (!voice_instrument[v]) voice_instrument[v] = &organ;
+    }
+    control_div = sample_rate / ENV_CONTROL_HZ;
+    if (control_div == 0) control_div = 1;
+    control_count = control_div;
+    max_cycles = 0;
+    total_cycles = 0;
+    samples = 0;
+
+    // Start the DWT cycle counter to time each sample
+    DEMCR |= (1 << 24);   // TRCENA
+    DWT_CTRL |= (1 << 0); // CYCCNTENA
+
+    // TIM16: undivided 80 MHz clock, fixed carrier period; the duty starts at 50% (silence)
+    TIM16->CR1 &= ~(1 << 0);      // CEN off while reconfiguring
+    TIM16->PSC = 0;
+    TIM16->ARR = DDS_ARR;
+    TIM16->CCR1 = (DDS_ARR + 1) / 2;
+    TIM16->EGR |= 1;              // UG: load PSC, ARR and CCR1
+    TIM16->CR1 |= (1 << 0);       // CEN
+
+    // TIM6: one update event per sample
+    RCC->APB1ENR1 |= (1 << 4);    // TIM6EN
+    TIM6->CR1 &= ~(1 << 0);
+    TIM6->PSC = 0;
+    TIM6->ARR = (80000000 / sample_rate) - 1;
+    TIM6->CR1 |= (1 << 2);        // URS: only counter overflow raises UIF, not the UG below
+    TIM6->EGR |= 1;               // UG
+    TIM6->SR &= ~(1);             // Clear UIF
+    TIM6->DIER |= 1;              // UIE
+    NVIC_ISER1 = (1 << (TIM6_IRQn - 32));
+    TIM6->CR1 |= (1 << 0);        // CEN
+}
+
+void stop_DDS(void){
+    TIM6->DIER &= ~(1);           // UIE off: no more samples
+    TIM6->CR1 &= ~(1 << 0);
+    TIM6->SR &= ~(1);
+
+    PWM_frequency(0);             // back to the note player's per-note PSC/ARR (stopped)
+}
+
+void DDS_frequency(int frequency){
+    DDS_voice(0, frequency);
+}
+
+void DDS_voice(int voice, int frequency){
+    if (voice < 0 || voice >= DDS_VOICES) return;
+    if (frequency == 0) {
+        command[voice] = VOICE_NOTE_OFF;
+        commands_pending = 1;
+        return;
+    }
+    // increment = frequency * 2^32 / sample_rate, exact for every audible frequency below rate / 2
+    next_increment[voice] = (uint32_t)(((uint64_t)frequency << 32) / rate);
+    command[voice] = VOICE_NOTE_ON; // written after next_increment: the interrupt reads it after seeing this
+    commands_pending = 1;
+}
+
+void DDS_instrument(int voice, const instrument * inst){
+    if (voice < 0 || voice >= DDS_VOICES) return;
+    voice_instrument[voice] = inst ? inst : &organ;
+}
+
+int DDS_pending(void){
+    return commands_pending;
+}
+
+// Applies posted note on/off commands. Runs before the sample is mixed, and steps the envelope of a
+// changed voice once so the change is already in this sample (an attack of 0 ms jumps to full level).
+static void DDS_commands(void){
+    commands_pending = 0;
+    for (int v = 0; v < DDS_VOICES; v++) {
+        uint8_t cmd = command[v];
+        if (cmd == VOICE_NO_CHANGE) continue;
+        command[v] = VOICE_NO_CHANGE;
+
+        const instrument * inst = voice_instrument[v];
+        if (cmd == VOICE_NOTE_ON) {
+            increment[v] = next_increment[v];
+            env_note_on(&env[v], inst);
+        } else {
+            env_note_off(&env[v], inst);
+        }
+        env_tick(&env[v], inst);
+        if (env[v].stage == ENV_IDLE) increment[v] = 0;
+    }
+}
+
+// One envelope step for every voice along its ADSR curve
+static void DDS_control(void){
+    for (int v = 0; v < DDS_VOICES; v++) {
+        env_tick(&env[v], voice_instrument[v]);
+        if (env[v].stage == ENV_IDLE) increment[v] = 0; // release over: the voice stops adding
+    }
+}
+
+void DDS_waveform(const int16_t * table){
+    wave = table;
+}
+
+uint32_t DDS_max_cycles(void){
+    return max_cycles;
+}
+
+uint32_t DDS_load(void){
+    if (samples == 0) return 0;
+    // per mille of 80 MHz = average cycles per sample * rate * 1000 / 80000000
+    return (uint32_t)((total_cycles * rate) / ((uint64_t)samples * 80000));
+}
+
+uint32_t DDS_mix(void){
+    const int16_t * table = wave;
+    int32_t sum = 0;
+
+    for (int v = 0; v < DDS_VOICES; v++) {
+        uint32_t step = increment[v];
+        if (step == 0) continue; // an idle voice adds nothing (a square table is not 0 at phase 0)
+        phase[v] += step;
+        sum += (table[phase[v] >> (32 - DDS_TABLE_BITS)] * (int32_t)env[v].level) >> 15;
+    }
+
+    // Saturate the scaled sum to Q15, then map it to +/- half the carrier period around the midpoint
+    sum >>= DDS_MIX_SHIFT;
+    if (sum > 32767) sum = 32767;
+    if (sum < -32767) sum = -32767;
+    return (uint32_t)((DDS_ARR + 1) / 2 + ((sum * ((DDS_ARR + 1) / 2)) >> 15)); // silence: 50% duty
+}
+
+// TIM6 update interrupt (vector shared with the DAC): output one sample
+void TIM6_DAC_IRQHandler(void){
+    uint32_t start = DWT_CYCCNT;
+    TIM6->SR &= ~(1); // Clear UIF
+
+    if (commands_pending) DDS_commands(); // note on/off posted since the last sample
+
+    TIM16->CCR1 = DDS_mix(); // preloaded (OC1PE): takes effect at the next carrier period
+
+    // Envelopes move at ENV_CONTROL_HZ, after the sample is out
+    if (--control_count == 0) {
+        control_count = control_div;
+        DDS_control();
+    }
+
+    uint32_t cycles = DWT_CYCCNT - start;
+    if (cycles > max_cycles) max_cycles = cycles;
+    total_cycles += cycles;
+    samples++;
+}
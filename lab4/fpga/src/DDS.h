@@ -0,0 +1,115 @@
+// Filename: DDS_h
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+// Direct digital synthesis on TIM16: a fast PWM carrier whose duty follows a mix of wavetable voices, updated by TIM6.
+
+#ifndef DDS_H
+#define DDS_H
+
+#include <stdint.h>
+#include "PWM.h"
+#include "ENVELOPE.h"
+#include "STM32L432KC_RCC.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define __IO volatile
+
+// Base addresses
+#define TIM6_BASE (0x40001000UL) // base address of TIM6 (basic timer) in BUS APB1 p68
+
+#define DDS_CARRIER_HZ 80000                        // TIM16 PWM carrier, well above hearing (speaker/RC filter removes it)
+#define DDS_ARR ((80000000 / DDS_CARRIER_HZ) - 1)   // 999 -> 1000 duty levels
+#define DDS_TABLE_BITS 8                            // 256-entry wavetables, indexed by the top 8 bits of the phase
+#define DDS_VOICES 4                                // simultaneous voices, each with its own phase accumulator
+#define DDS_MIX_SHIFT 2                             // voice sum >> 2 before saturation: all four full-scale voices fit
+#if (1 << DDS_MIX_SHIFT) < DDS_VOICES
+#error "DDS_MIX_SHIFT too small for DDS_VOICES: chords would clip (host/DDS_BENCH.c)"
+#endif
+
+// NVIC (Cortex-M4 core peripheral, PM0214 4.3)
+#define TIM6_IRQn 54                                  // TIM6_DAC global interrupt (RM0394 table 46)
+
+// CHAPTER 29.4: TIM6/TIM7 registers
+typedef struct
+{
+  __IO uint32_t CR1;          /*!< TIM6 control register 1,                                                Address offset: 0x00 */
+  __IO uint32_t CR2;          /*!< TIM6 control register 2,                                                Address offset: 0x04 */
+       uint32_t RESERVED0;    /*!< Reserved,                                                               Address offset: 0x08 */
+  __IO uint32_t DIER;         /*!< TIM6 DMA/interrupt enable register,                                     Address offset: 0x0C */
+  __IO uint32_t SR;           /*!< TIM6 status register,                                                   Address offset: 0x10 */
+  __IO uint32_t EGR;          /*!< TIM6 event generation register,                                         Address offset: 0x14 */
+       uint32_t RESERVED1[3]; /*!< Reserved,                                                               Address offset: 0x18 */
+  __IO uint32_t CNT;          /*!< TIM6 counter,                                                           Address offset: 0x24 */
+  __IO uint32_t PSC;          /*!< TIM6 prescaler,                                                         Address offset: 0x28 */
+  __IO uint32_t ARR;          /*!< TIM6 auto-reload register,                                              Address offset: 0x2C */
+} TIM6_TypeDef;
+
+#if defined(__ARM_ARCH)
+#define TIM6 ((TIM6_TypeDef *) TIM6_BASE)
+#define NVIC_ISER1 (*(__IO uint32_t *) 0xE000E104UL) // Interrupt set-enable register for IRQ 32..63
+
+// DWT cycle counter (PM0214 / ARMv7-M), used to measure the per-sample cost
+#define DEMCR      (*(__IO uint32_t *) 0xE000EDFCUL) // bit 24 TRCENA enables DWT
+#define DWT_CTRL   (*(__IO uint32_t *) 0xE0001000UL) // bit 0 CYCCNTENA
+#define DWT_CYCCNT (*(__IO uint32_t *) 0xE0001004UL) // core clock cycles
+#else
+extern TIM6_TypeDef sim_TIM6;                        // host build: simulated by the host tools
+extern uint32_t sim_NVIC_ISER1, sim_DEMCR, sim_DWT_CTRL, sim_DWT_CYCCNT;
+#define TIM6 (&sim_TIM6)
+#define NVIC_ISER1 sim_NVIC_ISER1
+#define DEMCR      sim_DEMCR
+#define DWT_CTRL   sim_DWT_CTRL
+#define DWT_CYCCNT sim_DWT_CYCCNT
+#endif
+
+// Built-in wavetables: 256 signed samples (Q15, -32767..32767) per cycle
+extern const int16_t DDS_SINE[256];
+extern const int16_t DDS_TRIANGLE[256];
+extern const int16_t DDS_SQUARE[256];
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+/* Switches TIM16 to a DDS_CARRIER_HZ carrier and starts TIM6 interrupts at the sample rate.
+ * Each interrupt advances a 32-bit phase accumulator and writes the wavetable sample to CCR1.
+ *    -- sample_rate: samples per second, e.g. 8000, 16000 or 32000 */
+void init_DDS(uint32_t sample_rate);
+
+/* Stops the sample interrupt and puts TIM16 back in PWM_frequency() mode (stopped) */
+void stop_DDS(void);
+
+/* Sets the tone frequency of voice 0 (0 = silence: duty held at 50%, no sound) */
+void DDS_frequency(int frequency);
+
+/* Starts or ends a note on one voice; all voices are summed with saturation into CCR1.
+ * The change is applied by the next sample interrupt (within 1 / sample_rate).
+ *    -- voice: 0 .. DDS_VOICES - 1
+ *    -- frequency: Hz (note on: attack from the current level), 0 = note off (release) */
+void DDS_voice(int voice, int frequency);
+
+/* Sets the envelope a voice uses from its next note on (NULL = INSTRUMENT_ORGAN, the default)
+ *    -- inst: must stay valid while the voice plays */
+void DDS_instrument(int voice, const instrument * inst);
+
+/* Returns 1 while a DDS_voice() change waits for the next sample interrupt */
+int DDS_pending(void);
+
+/* Mixes the next sample of every voice (advances their phases)
+ *    -- return: CCR1 duty, 0 .. DDS_ARR */
+uint32_t DDS_mix(void);
+
+/* Selects the waveform of every voice: DDS_SINE, DDS_TRIANGLE, DDS_SQUARE or a custom 256-entry Q15 table */
+void DDS_waveform(const int16_t * table);
+
+/* Returns the worst-case cycles spent in one sample interrupt since init_DDS()
+ * (handler body only: add ~24 cycles of exception entry/exit for the full cost) */
+uint32_t DDS_max_cycles(void);
+
+/* Returns the CPU load of the sample interrupt in per mille (average cycles per sample x sample rate / 80 MHz) */
+uint32_t DDS_load(void);
+
+#endif
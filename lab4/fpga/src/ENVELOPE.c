@@ -0,0 +1,58 @@
+// Filename: ENVELOPE.c
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+
+// ADSR envelopes without floating point. Every stage moves the level from one value to another along
+// the same precomputed curve: 65 Q15 points of (1 - e^(-4x)) / (1 - e^(-4)), fast at first and settling
+// at the end like an RC charge. Each tick adds a Q16 step to the curve position; the step is set once
+// per stage from the stage time, so a tick only divides on the tick that starts a new stage.
+
+#include "ENVELOPE.h"
+
+static const uint16_t env_curve[65] = {
+         0,   2022,   3922,   5707,   7383,   8958,  10438,  11828,  13133,  14360,  15512,  16595,  17612,  18567,  19464,  20307,
+     21099,  21843,  22542,  23199,  23815,  24395,  24939,  25450,  25931,  26382,  26806,  27204,  27578,  27929,  28260,  28570,
+     28861,  29135,  29392,  29633,  29860,  30073,  30274,  30462,  30638,  30804,  30960,  31107,  31245,  31374,  31495,  31609,
+     31717,  31817,  31912,  32001,  32084,  32163,  32236,  32305,  32370,  32431,  32489,  32543,  32593,  32641,  32686,  32728,
+     32767,
+};
+
+#define ENV_END ((uint32_t)1 << (ENV_CURVE_BITS + 16)) // curve position at the end of a stage
+
+// Enters a stage that goes from the current level to target over ms milliseconds
+static void start_stage(env_state * env, uint8_t stage, uint16_t target, uint16_t ms) {
+    uint32_t ticks = (uint32_t)ms * ENV_CONTROL_HZ / 1000;
+    env->stage = stage;
+    env->from = env->level;
+    env->to = target;
+    env->pos = 0;
+    env->step = (ticks == 0) ? ENV_END : ENV_END / ticks; // 0 ms: done at the next tick
+}
+
+void env_note_on(env_state * env, const instrument * inst){
+    start_stage(env, ENV_ATTACK, ENV_FULL, inst->attack_ms);
+}
+
+void env_note_off(env_state * env, const instrument * inst){
+    if (env->stage == ENV_IDLE) return;
+    start_stage(env, ENV_RELEASE, 0, inst->release_ms);
+}
+
+uint16_t env_tick(env_state * env, const instrument * inst){
+    if (env->stage == ENV_IDLE || env->stage == ENV_SUSTAIN) return env->level;
+
+    env->pos += env->step;
+    if (env->pos >= ENV_END) {
+        // Stage over: land exactly on its target and move on
+        env->level = env->to;
+        if (env->stage == ENV_ATTACK) start_stage(env, ENV_DECAY, inst->sustain, inst->decay_ms);
+        else if (env->stage == ENV_DECAY) env->stage = ENV_SUSTAIN;
+        else env->stage = ENV_IDLE;
+        return env->level;
+    }
+
+    // level = from + (to - from) * curve(pos)
+    int32_t shape = env_curve[env->pos >> 16];
+    env->level = (uint16_t)(env->from + (((int32_t)env->to - env->from) * shape >> 15));
+    return env->level;
+}
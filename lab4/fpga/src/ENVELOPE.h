@@ -0,0 +1,60 @@
+// Filename: ENVELOPE_h
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+// ADSR envelope generator: one Q15 gain per voice, stepped at a control rate along a precomputed curve.
+
+#ifndef ENVELOPE_H
+#define ENVELOPE_H
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define ENV_CONTROL_HZ 1000  // envelope steps per second (ticked from the DDS sample interrupt)
+#define ENV_CURVE_BITS 6     // 64 curve segments per stage
+#define ENV_FULL 32767       // Q15 gain 1.0
+
+// An instrument's envelope (part of the song's voice setup, see POLY_SONG.h)
+typedef struct
+{
+  uint16_t attack_ms;   // 0 -> full level at once
+  uint16_t decay_ms;    // full level -> sustain
+  uint16_t sustain;     // Q15 level held while the note is on (ENV_FULL = no decay)
+  uint16_t release_ms;  // level -> 0 after note off
+} instrument;
+
+// Instrument initializers: {attack, decay, sustain, release}
+#define INSTRUMENT_ORGAN  {0, 0, ENV_FULL, 0}        // on/off, the plain DDS tone
+#define INSTRUMENT_PLUCK  {5, 300, 8192, 150}        // fast attack, decays to 1/4
+#define INSTRUMENT_PAD    {200, 400, 24576, 400}     // slow swell and fade
+
+typedef enum { ENV_IDLE, ENV_ATTACK, ENV_DECAY, ENV_SUSTAIN, ENV_RELEASE } env_stage;
+
+// Envelope state of one voice (owned by the control-rate interrupt)
+typedef struct
+{
+  uint8_t stage;        // env_stage
+  uint32_t pos;         // Q16 position along the curve: 0 .. 64 << 16
+  uint32_t step;        // Q16 curve segments per control tick for the current stage
+  uint16_t from;        // level at the start of the stage
+  uint16_t to;          // level at the end of the stage
+  uint16_t level;       // current Q15 gain
+} env_state;
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+/* Starts the attack from the current level (a retriggered note does not jump to 0) */
+void env_note_on(env_state * env, const instrument * inst);
+
+/* Starts the release from the current level */
+void env_note_off(env_state * env, const instrument * inst);
+
+/* Advances one control tick: a shift, a table lookup and a multiply (one division when a stage starts)
+ *    -- return: Q15 gain; 0 with stage ENV_IDLE once the release is over */
+uint16_t env_tick(env_state * env, const instrument * inst);
+
+#endif
@@ -0,0 +1,106 @@
+// Filename: MIDI.c
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+
+// MIDI byte parser and voice allocator. Runs entirely in the USART2 receive interrupt: the last
+// byte of a note message posts a DDS_voice() command, which the next DDS sample interrupt applies.
+// The USART2 and TIM6 interrupts share one priority, so they never preempt each other.
+
+#include "MIDI.h"
+#include "PITCHES.h"
+#include "STM32L432KC_USART.h"
+
+#define NO_NOTE 0xFF
+
+// Parser state
+static uint8_t running_status = 0; // last channel status byte, 0 = none yet
+static uint8_t data[2];
+static uint8_t data_count = 0;
+
+// Voice allocation: which note each DDS voice holds, and when it got it
+static uint8_t voice_note[DDS_VOICES];
+static uint32_t voice_age[DDS_VOICES];
+static uint32_t age = 0;
+static uint32_t steals = 0;
+
+// Data bytes that follow a channel status byte (program change and channel pressure take one)
+static uint8_t data_length(uint8_t status) {
+    uint8_t kind = status & 0xF0;
+    return (kind == 0xC0 || kind == 0xD0) ? 1 : 2;
+}
+
+static void note_on(uint8_t note) {
+    int pick = -1;
+
+    // Same note again: retrigger its voice
+    for (int v = 0; v < DDS_VOICES; v++) if (voice_note[v] == note) pick = v;
+
+    // Else the free voice released longest ago, else steal the oldest sounding note
+    if (pick < 0) {
+        for (int v = 0; v < DDS_VOICES; v++) {
+            if (voice_note[v] == NO_NOTE && (pick < 0 || voice_age[v] < voice_age[pick])) pick = v;
+        }
+    }
+    if (pick < 0) {
+        pick = 0;
+        for (int v = 1; v < DDS_VOICES; v++) if (voice_age[v] < voice_age[pick]) pick = v;
+        steals++;
+    }
+
+    voice_note[pick] = note;
+    voice_age[pick] = ++age;
+    DDS_voice(pick, pitch_hz(note));
+}
+
+static void note_off(uint8_t note) {
+    for (int v = 0; v < DDS_VOICES; v++) {
+        if (voice_note[v] != note) continue;
+        voice_note[v] = NO_NOTE;
+        voice_age[v] = ++age;
+        DDS_voice(v, 0); // release
+    }
+}
+
+void midi_byte(uint8_t byte){
+    if (byte >= 0xF8) return;           // real-time (clock, start, stop...): no effect on the message
+
+    if (byte & 0x80) {
+        // Channel status starts a message and becomes the running status;
+        // system common and SysEx (0xF0..0xF7) cancel it, so their data bytes are skipped
+        running_status = (byte < 0xF0) ? byte : 0;
+        data_count = 0;
+        return;
+    }
+
+    if (running_status == 0) return;    // data byte with no message to belong to
+    data[data_count++] = byte;
+    if (data_count < data_length(running_status)) return;
+    data_count = 0;                     // complete; the next data bytes reuse the running status
+
+    uint8_t kind = running_status & 0xF0;
+    if (kind == MIDI_NOTE_ON && data[1] != 0) note_on(data[0]);
+    else if (kind == MIDI_NOTE_ON || kind == MIDI_NOTE_OFF) note_off(data[0]);
+}
+
+void midi_reset(void){
+    running_status = 0;
+    data_count = 0;
+    for (int v = 0; v < DDS_VOICES; v++) {
+        DDS_voice(v, 0);
+        voice_note[v] = NO_NOTE;
+        voice_age[v] = 0;
+    }
+    age = 0;
+    steals = 0;
+}
+
+void init_MIDI(const instrument * voices){
+    for (int v = 0; v < DDS_VOICES; v++) DDS_instrument(v, voices ? &voices[v] : 0);
+    midi_reset();
+    initUSART(MIDI_BAUD);
+    USART_on_receive(midi_byte);
+}
+
+uint32_t midi_steals(void){
+    return steals;
+}
@@ -0,0 +1,41 @@
+// Filename: MIDI_h
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+// Live MIDI synthesizer: note on/off messages from USART2 start and stop DDS voices.
+
+#ifndef MIDI_H
+#define MIDI_H
+
+#include <stdint.h>
+#include "DDS.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define MIDI_BAUD 31250 // MIDI wire rate: one 3-byte message every 960 us
+
+// Status bytes (high nibble; low nibble = channel, all channels are played)
+#define MIDI_NOTE_OFF 0x80
+#define MIDI_NOTE_ON  0x90
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+/* Listens for MIDI on USART2 (initUSART() at MIDI_BAUD). init_DDS() must run first.
+ *    -- voices: DDS_VOICES instruments (envelopes), NULL = INSTRUMENT_ORGAN for all */
+void init_MIDI(const instrument * voices);
+
+/* Parses one received byte (the USART2 receive callback). Handles running status, note on with
+ * velocity 0 as note off, real-time bytes anywhere and skips every other message and SysEx.
+ * A note on takes a free voice, or steals the voice whose note started first. */
+void midi_byte(uint8_t byte);
+
+/* Releases every voice and resets the parser */
+void midi_reset(void);
+
+/* Returns how many note ons had to steal a sounding voice */
+uint32_t midi_steals(void);
+
+#endif
@@ -0,0 +1,24 @@
+// Filename: PACKED_SONG.c
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+
+// Streaming decoder for packed songs: one 16-bit word in, one {Hz, ms} note out.
+
+#include "PACKED_SONG.h"
+
+void song_reader_start(song_reader * reader, const packed_song * song){
+    reader->song = song;
+    reader->index = 0;
+}
+
+int song_reader_next(song_reader * reader, int * frequency, int * duration){
+    if (reader->index >= reader->song->length) return 0;
+
+    uint16_t note = reader->song->notes[reader->index];
+    if (PACKED_UNITS(note) == 0) return 0; // end marker
+
+    reader->index++;
+    *frequency = pitch_hz(PACKED_MIDI(note));
+    *duration = PACKED_UNITS(note) * reader->song->tempo_ms;
+    return 1;
+}
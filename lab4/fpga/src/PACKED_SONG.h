@@ -0,0 +1,56 @@
+// Filename: PACKED_SONG_h
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+// Packed song format: one 16-bit word per note plus a per-song tempo base, decoded one note at a time.
+
+#ifndef PACKED_SONG_H
+#define PACKED_SONG_H
+
+#include <stdint.h>
+#include "PITCHES.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+// Note word: bits 15:8 = MIDI note number (0 = rest), bits 7:0 = duration in tempo units (0 = end of song).
+// 2 bytes per note instead of 8 for a const int[2] pair; pitches come from the shared pitch_hz() table.
+#define PACK_NOTE(midi, units) ((uint16_t)(((midi) << 8) | (units)))
+#define PACKED_MIDI(note)  ((note) >> 8)
+#define PACKED_UNITS(note) ((note) & 0xFF)
+
+// Packed initializer for a song list entry (SONGS.h); the build fails (negative array size)
+// if the duration is not a whole number of tempo units or needs more than 255 of them
+#define NOTE_PACKED(name, ms, tempo_ms) \
+    (PACK_NOTE(PITCH_MIDI(name), (ms) / (tempo_ms)) \
+     + 0 * sizeof(char[((ms) % (tempo_ms) == 0 && (ms) / (tempo_ms) <= 0xFF) ? 1 : -1])),
+
+// A packed song in flash
+typedef struct
+{
+  uint16_t tempo_ms;      // duration of one time unit in ms
+  uint16_t length;        // number of note words
+  const uint16_t * notes; // note words, see PACK_NOTE()
+} packed_song;
+
+// Streaming decoder state: where the player is in a packed song
+typedef struct
+{
+  const packed_song * song;
+  uint16_t index; // next note word
+} song_reader;
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+/* Points a reader at the first note of a packed song */
+void song_reader_start(song_reader * reader, const packed_song * song);
+
+/* Decodes the next note of a song.
+ *    -- frequency: set to the pitch in Hz (0 = rest)
+ *    -- duration: set to the duration in ms
+ *    -- return: 1 if a note was decoded, 0 at the end of the song */
+int song_reader_next(song_reader * reader, int * frequency, int * duration);
+
+#endif
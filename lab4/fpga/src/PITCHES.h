@@ -0,0 +1,106 @@
+// Filename: PITCHES_h
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+// Note names for the song lists: each PITCH_<name> is (MIDI note number, frequency in Hz),
+// equal temperament with A4 = 440 Hz, rounded to the nearest Hz. Sharps are written S (CS4 = C#4).
+
+#ifndef PITCHES_H
+#define PITCHES_H
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+// Picking one half of a pitch at compile time: PITCH_HZ(E5) -> 659, PITCH_MIDI(E5) -> 76
+#define PITCH_MIDI(name) PITCH_FIRST(PITCH_##name)
+#define PITCH_HZ(name)   PITCH_SECOND(PITCH_##name)
+#define PITCH_FIRST(pair)  PITCH_FIRST_ pair
+#define PITCH_SECOND(pair) PITCH_SECOND_ pair
+#define PITCH_FIRST_(midi, hz)  midi
+#define PITCH_SECOND_(midi, hz) hz
+
+#define PITCH_REST (0, 0) // silence (MIDI note 0 is reserved for it)
+#define PITCH_C2   (36, 65)
+#define PITCH_CS2  (37, 69)
+#define PITCH_D2   (38, 73)
+#define PITCH_DS2  (39, 78)
+#define PITCH_E2   (40, 82)
+#define PITCH_F2   (41, 87)
+#define PITCH_FS2  (42, 92)
+#define PITCH_G2   (43, 98)
+#define PITCH_GS2  (44, 104)
+#define PITCH_A2   (45, 110)
+#define PITCH_AS2  (46, 117)
+#define PITCH_B2   (47, 123)
+#define PITCH_C3   (48, 131)
+#define PITCH_CS3  (49, 139)
+#define PITCH_D3   (50, 147)
+#define PITCH_DS3  (51, 156)
+#define PITCH_E3   (52, 165)
+#define PITCH_F3   (53, 175)
+#define PITCH_FS3  (54, 185)
+#define PITCH_G3   (55, 196)
+#define PITCH_GS3  (56, 208)
+#define PITCH_A3   (57, 220)
+#define PITCH_AS3  (58, 233)
+#define PITCH_B3   (59, 247)
+#define PITCH_C4   (60, 262)
+#define PITCH_CS4  (61, 277)
+#define PITCH_D4   (62, 294)
+#define PITCH_DS4  (63, 311)
+#define PITCH_E4   (64, 330)
+#define PITCH_F4   (65, 349)
+#define PITCH_FS4  (66, 370)
+#define PITCH_G4   (67, 392)
+#define PITCH_GS4  (68, 415)
+#define PITCH_A4   (69, 440)
+#define PITCH_AS4  (70, 466)
+#define PITCH_B4   (71, 494)
+#define PITCH_C5   (72, 523)
+#define PITCH_CS5  (73, 554)
+#define PITCH_D5   (74, 587)
+#define PITCH_DS5  (75, 622)
+#define PITCH_E5   (76, 659)
+#define PITCH_F5   (77, 698)
+#define PITCH_FS5  (78, 740)
+#define PITCH_G5   (79, 784)
+#define PITCH_GS5  (80, 831)
+#define PITCH_A5   (81, 880)
+#define PITCH_AS5  (82, 932)
+#define PITCH_B5   (83, 988)
+#define PITCH_C6   (84, 1047)
+#define PITCH_CS6  (85, 1109)
+#define PITCH_D6   (86, 1175)
+#define PITCH_DS6  (87, 1245)
+#define PITCH_E6   (88, 1319)
+#define PITCH_F6   (89, 1397)
+#define PITCH_FS6  (90, 1480)
+#define PITCH_G6   (91, 1568)
+#define PITCH_GS6  (92, 1661)
+#define PITCH_A6   (93, 1760)
+#define PITCH_AS6  (94, 1865)
+#define PITCH_B6   (95, 1976)
+#define PITCH_C7   (96, 2093)
+#define PITCH_CS7  (97, 2217)
+#define PITCH_D7   (98, 2349)
+#define PITCH_DS7  (99, 2489)
+#define PITCH_E7   (100, 2637)
+#define PITCH_F7   (101, 2794)
+#define PITCH_FS7  (102, 2960)
+#define PITCH_G7   (103, 3136)
+#define PITCH_GS7  (104, 3322)
+#define PITCH_A7   (105, 3520)
+#define PITCH_AS7  (106, 3729)
+#define PITCH_B7   (107, 3951)
+#define PITCH_C8   (108, 4186)
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+/* Returns the frequency in Hz of a MIDI note number (0 -> 0 = rest) from a 128-entry table */
+uint16_t pitch_hz(uint8_t midi);
+
+#endif
@@ -0,0 +1,27 @@
+// Filename: POLY_SONG.c
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+
+// Plays chord steps: every voice gets its own DDS phase accumulator and ADSR envelope (DDS.c), which sums them into CCR1.
+
+#include "POLY_SONG.h"
+#include "TIMER.h"
+
+void play_poly_song(const poly_step * song, int len, const instrument * voices){
+    uint16_t release = 0;
+    for (int v = 0; v < DDS_VOICES; v++) {
+        DDS_instrument(v, voices ? &voices[v] : 0);
+        if (voices && voices[v].release_ms > release) release = voices[v].release_ms;
+    }
+
+    for (int i = 0; i < len && song[i].ms != 0; i++) {
+        for (int v = 0; v < DDS_VOICES; v++) {
+            if (song[i].midi[v] == PITCH_MIDI(HOLD)) continue; // keep the note from the previous step
+            DDS_voice(v, pitch_hz(song[i].midi[v]));
+        }
+        delaying(song[i].ms);
+    }
+
+    for (int v = 0; v < DDS_VOICES; v++) DDS_voice(v, 0);
+    if (release) delaying(release); // let the notes fade out
+}
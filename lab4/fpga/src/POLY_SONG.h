@@ -0,0 +1,42 @@
+// Filename: POLY_SONG_h
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+// Polyphonic song format: each step sets all DDS voices at once, so songs can have chords and held notes.
+
+#ifndef POLY_SONG_H
+#define POLY_SONG_H
+
+#include <stdint.h>
+#include "PITCHES.h"
+#include "DDS.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+// Voice entry that keeps the voice's previous note sounding through the step (overlapping notes).
+// REST (MIDI 0) turns the voice off.
+#define PITCH_HOLD (0xFF, 0)
+
+// One step: a duration and a MIDI note number (or 0xFF = hold) per voice
+typedef struct
+{
+  uint16_t ms;                 // step duration (0 = end of song)
+  uint8_t midi[DDS_VOICES];    // note per voice: 0 = off, 0xFF = hold, else MIDI note number
+} poly_step;
+
+// Builds a poly_step initializer from a duration and four note names (PITCHES.h, REST or HOLD)
+#define POLY_STEP(ms, v0, v1, v2, v3) {ms, {PITCH_MIDI(v0), PITCH_MIDI(v1), PITCH_MIDI(v2), PITCH_MIDI(v3)}},
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+/* Plays a polyphonic song through the DDS mixer (init_DDS() first). Each step starts a note (attack)
+ * or a REST (release) on every voice that is not held, then waits its duration with delaying().
+ * At the end every voice is released and the longest release is waited out.
+ *    -- song: steps, stops after len steps or at a step whose duration is 0
+ *    -- voices: DDS_VOICES instruments (envelopes), one per voice; NULL = INSTRUMENT_ORGAN for all */
+void play_poly_song(const poly_step * song, int len, const instrument * voices);
+
+#endif
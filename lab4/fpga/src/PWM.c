@@ -7,7 +7,8 @@ File    : PWM.c
 Purpose : Configure TIM16 Channel 1 to generate a PWM signal
           The PWM signal is used to play notes through a speaker. 
           init_PWM() sets up TIM16 in PWM mode.
-          PWM_frequency(frequency) updates ARR and CCR1 to generate a desired note frequency.
+          PWM_frequency(frequency) updates PSC, ARR and CCR1 to generate a desired note frequency
+          (the PSC/ARR pair is picked per note for the smallest pitch error).
           
           TIM16_CH1 output is mapped to PA6 (as set in main.c), 
           and the duty cycle is fixed at 50% for square wave audio output.
@@ -16,6 +17,12 @@ Purpose : Configure TIM16 Channel 1 to generate a PWM signal
 
 #include "PWM.h"
 
+// Click-free mode stages notes in preload registers, which read back the staged values, not the live
+// ones. So track both: is the counter halted on ARR = 0 now, and will the staged values halt it.
+// An update event (UIF) since the last PWM_set() means the staged values went live.
+static int active_stopped = 1;
+static int staged_stopped = 1;
+
 void init_PWM() {
    
     // Set the timer prescaler to slow down the timer ticks.
@@ -41,6 +48,7 @@ void init_PWM() {
 
     // Generate an update event (UG = 1) to load PSC, ARR, CCR1 values
     TIM16->EGR |= (1 << 0); // UG
+    active_stopped = staged_stopped = (TIM16->ARR == 0);
 
     // Enable the counter (CEN = 1) → PWM starts running
     TIM16->CR1 |= (1 << 0); // CEN
@@ -51,13 +59,76 @@ void init_PWM() {
 
 
 
-void PWM_frequency(int frequency){
-    // Calculate ARR value for desired frequency
+uint32_t PWM_psc(int frequency){
+    // Smallest prescaler that keeps ARR within 16 bits (finest pitch step)
+    return PWM_PSC_OPT(frequency);
+}
+
+uint32_t PWM_arr(int frequency){
+    // Calculate ARR value for desired frequency with the PWM_psc() prescaler
     // If frequency = 0 → stop PWM (ARR = 0)
-    uint32_t arr_max_val  = (frequency == 0) ? 0 : ((80000000 / (PSC_PWM + 1)) / frequency) - 1;
+    return PWM_ARR_OPT(frequency);
+}
+
+void PWM_split(uint32_t cycles, uint32_t * psc, uint32_t * arr){
+    uint32_t div = (cycles - 1) / 65536 + 1;   // PSC + 1
+    *psc = div - 1;
+    *arr = (cycles + div / 2) / div - 1;       // rounded
+}
+
+void PWM_frequency(int frequency){
+    uint32_t arr_max_val = PWM_arr(frequency);
+    PWM_set(PWM_psc(frequency), arr_max_val, arr_max_val / 2);
+}
+
+// 1 once PWM_click_free(1) was called: note changes wait for the end of the current period
+static int click_free = 0;
+
+void PWM_click_free(int enable){
+    click_free = enable;
+
+    // ARPE (CR1 bit 7): ARR writes go to a preload register like CCR1 already does (OC1PE)
+    if (enable) TIM16->CR1 |= (1 << 7);
+    else        TIM16->CR1 &= ~(1 << 7);
+
+    // Without ARPE the ARR just written is the live one
+    active_stopped = staged_stopped = (TIM16->ARR == 0);
+    TIM16->SR &= ~(1); // Clear UIF
+}
+
+int PWM_is_click_free(void){
+    return click_free;
+}
+
+void PWM_set(uint32_t psc, uint32_t arr_max_val, uint32_t ccr1){
+    if (click_free) {
+        // Stage both values in the preload registers. UDIS (CR1 bit 1) holds back the preload transfer
+        // while writing, so ARR and CCR1 always switch in the same period, and no update event can
+        // come between reading and clearing UIF.
+        TIM16->CR1 |= (1 << 1);  // UDIS
+        if (TIM16->SR & 1) active_stopped = staged_stopped; // the last staged values went live
+        TIM16->SR &= ~(1);       // Clear UIF
+        TIM16->PSC = psc;        // PSC is always preloaded
+        TIM16->ARR = arr_max_val;
+        TIM16->CCR1 = ccr1;
+        staged_stopped = (arr_max_val == 0);
+        TIM16->CR1 &= ~(1 << 1);
+
+        // The counter halts on ARR = 0 (rest), so no update event would ever load the new note: load now.
+        // A rest that is only staged (still waiting for the end of the period) is simply replaced.
+        if (active_stopped) {
+            TIM16->EGR |= 1;
+            active_stopped = staged_stopped;
+        }
+        // Otherwise the current period runs to its end and the overflow update event switches notes
+        return;
+    }
 
     // We want to reset the counter
     TIM16->CNT = 0; // CNT
+
+    // Prescaler for this note (preloaded: the update event below loads it)
+    TIM16->PSC = psc;
     
     // Generate update event to load ARR and PSC immediately
     TIM16 -> EGR |= 1;  //->starts from 0
@@ -65,8 +136,16 @@ void PWM_frequency(int frequency){
     // Set auto-reload register (ARR) → determines PWM period   ->ARR = ms;-> Clock cycles you can do 
     TIM16->ARR = arr_max_val;
 
-    // set the duty cycle to 50% of period (square wave)
-    TIM16->CCR1 = arr_max_val / 2; // CCR
+    // set the duty cycle (50% of period for a square wave)
+    TIM16->CCR1 = ccr1; // CCR
+    active_stopped = staged_stopped = (arr_max_val == 0);
+}
+
+void PWM_stop(void){
+    TIM16->ARR = 0;
+    TIM16->CCR1 = 0;
+    TIM16->EGR |= 1; // UG: load both (and the repetition counter) now, even in click-free mode
+    active_stopped = staged_stopped = 1;
 }
 
 
@@ -28,6 +28,15 @@
   //If PSC too low → ARR might exceed 16-bit limit for low notes.
   //If PSC too high → timer resolution drops → PWM frequency may be inaccurate
 
+// Per-note (PSC, ARR) solver, usable at compile time. A note lasts 80 MHz / hz cycles = (PSC + 1) * (ARR + 1).
+// The smallest PSC that keeps ARR + 1 <= 65536 gives the finest ARR step; ARR is then rounded, so the
+// period is off by at most half a prescaled tick: under 0.04 cents for every note up to C8 (4186 Hz)
+// (PSC_PWM = 25 truncates instead: +0.57 cents at 1319 Hz, +1.71 cents at 3951 Hz).
+// host/PITCH_REPORT.c prints both, note by note, for both songs and every named pitch.
+#define PWM_PSC_OPT(hz) ((hz) == 0 ? 0 : (uint32_t)((80000000UL - 1) / ((uint32_t)(hz) * 65536UL)))
+#define PWM_ARR_OPT(hz) ((hz) == 0 ? 0 : (uint32_t)((80000000UL + (uint32_t)(hz) * (PWM_PSC_OPT(hz) + 1) / 2) \
+                                                    / ((uint32_t)(hz) * (PWM_PSC_OPT(hz) + 1)) - 1))
+
 /**
   * @brief Reset and Clock Control
   */
@@ -62,7 +71,12 @@ typedef struct
        uint32_t      OR2;          /*!< TIM16 option register 2 (TIM16_OR2),                                    Address offset: 0x60 */
 } TIM16_TypeDef;
 
+#if defined(__ARM_ARCH)
 #define TIM16 ((TIM16_TypeDef *) TIM16_BASE)
+#else
+extern TIM16_TypeDef sim_TIM16;  // host build: register block simulated by the host tools (host/)
+#define TIM16 (&sim_TIM16)
+#endif
 
 ///////////////////////////////////////////////////////////////////////////////
 // Function prototypes
@@ -71,4 +85,32 @@ typedef struct
 void init_PWM(void);
 void PWM_frequency(int frequency);
 
+/* Returns the TIM16 PSC/ARR pair PWM_frequency() uses for a frequency in Hz (PWM_PSC_OPT/PWM_ARR_OPT,
+ * 0 -> ARR 0 = stopped) */
+uint32_t PWM_psc(int frequency);
+uint32_t PWM_arr(int frequency);
+
+/* Splits a period in 80 MHz cycles into the best PSC/ARR pair (same rule as PWM_PSC_OPT/PWM_ARR_OPT)
+ *    -- cycles: 2 .. 2^32 - 1 */
+void PWM_split(uint32_t cycles, uint32_t * psc, uint32_t * arr);
+
+/* Selects how PWM_set()/PWM_frequency() change notes:
+ *    -- enable = 0: reset the counter and switch at once (cuts the current period short, audible click)
+ *    -- enable = 1: stage ARR/CCR1 in the preload registers (ARPE on) and switch at the next
+ *       update event, so every PWM period is complete */
+void PWM_click_free(int enable);
+
+/* Returns the mode set by PWM_click_free() */
+int PWM_is_click_free(void);
+
+/* Same as PWM_frequency() with the register values already computed (e.g. by PWM_PSC_OPT()/PWM_ARR_OPT())
+ *    -- psc: prescaler
+ *    -- arr: period, 0 stops the PWM
+ *    -- ccr1: duty, arr / 2 for a square wave */
+void PWM_set(uint32_t psc, uint32_t arr, uint32_t ccr1);
+
+/* Silences TIM16 at once, cutting the current period short: ARR = 0 and CCR1 = 0 are loaded with an
+ * update event (UG), which also reloads the repetition counter from RCR */
+void PWM_stop(void);
+
 #endif
@@ -0,0 +1,124 @@
+// Filename: PWM_DMA.c
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+
+// Plays a song entirely in hardware. The song is compiled into {PSC, ARR, RCR, CCR1} records:
+// TIM16's repetition counter (RCR) holds the note duration as a number of PWM periods, so
+// TIM16's update event only fires when a note ends. With UDE and a 4-register DMA burst
+// (DCR: DBA = PSC, DBL = 4 transfers) every such event makes DMA1 write the next record
+// through DMAR into the preload registers, which take over at the following update event.
+
+#include "PWM_DMA.h"
+#include "SEQUENCER.h"
+
+int compile_song(const int (*song)[2], int len, pwm_record * records, int max_records) {
+    int count = 0;
+
+    for (int i = 0; i < len && song[i][1] != 0; i++) {
+        int frequency = song[i][0];
+        int rate = (frequency == 0) ? PWM_REST_FREQ : frequency;
+
+        // Same PSC/ARR/CCR1 as PWM_frequency(); a rest keeps a period but drives the output low
+        uint32_t psc = PWM_psc(rate);
+        uint32_t arr = PWM_arr(rate);
+        uint32_t ccr1 = (frequency == 0) ? 0 : arr / 2;
+
+        // Note duration in whole PWM periods (rounded), at least one
+        uint32_t periods = ((uint32_t)rate * song[i][1] + 500) / 1000;
+        if (periods == 0) periods = 1;
+
+        // Split into records of at most PWM_MAX_REPEAT periods each
+        while (periods > 0) {
+            uint32_t repeat = (periods > PWM_MAX_REPEAT) ? PWM_MAX_REPEAT : periods;
+            if (count >= max_records - 1) return 0; // keep room for the silent record
+            records[count].psc = psc;
+            records[count].arr = arr;
+            records[count].rcr = repeat - 1;
+            records[count].ccr1 = ccr1;
+            count++;
+            periods -= repeat;
+        }
+    }
+
+    // Silent record: stays loaded once the DMA channel runs out
+    records[count].psc = PWM_psc(PWM_REST_FREQ);
+    records[count].arr = PWM_arr(PWM_REST_FREQ);
+    records[count].rcr = 0;
+    records[count].ccr1 = 0;
+    return count + 1;
+}
+
+// 1 from play_song_dma() until the update event that loads the silent record (TIM16 interrupt)
+static volatile int dma_playing = 0;
+static int last_record = 0; // index of the last note record, reported with PLAYER_SONG_DONE
+
+void play_song_dma(const pwm_record * records, int count) {
+    stop_song_dma();
+    if (count < 2) return;
+
+    // Enable the DMA1 clock (AHB1ENR bit 0)
+    RCC->AHB1ENR |= (1 << 0); // DMA1EN
+
+    TIM16->CR1 &= ~(1 << 0);  // CEN off while the pipeline is primed
+    TIM16->CR1 |= (1 << 7);   // ARPE: ARR writes wait for the update event, like CCR1 (OC1PE)
+
+    // Record 0 waits in the preload registers for the UG below
+    TIM16->PSC = records[0].psc;
+    TIM16->ARR = records[0].arr;
+    TIM16->RCR = records[0].rcr;
+    TIM16->CCR1 = records[0].ccr1;
+
+    // DMA1 channel 6: memory -> TIM16->DMAR, 32-bit words, memory increment, one word per request
+    DMA1_CSELR = (DMA1_CSELR & ~(0xF << 20)) | (DMA_TIM16_UP_REQ << 20); // C6S
+    DMA1_Channel6->CPAR = (uint32_t)(uintptr_t) &TIM16->DMAR;
+    DMA1_Channel6->CMAR = (uint32_t)(uintptr_t) &records[1];
+    DMA1_Channel6->CNDTR = 4 * (count - 1);  // every record after record 0, the silent one included
+    DMA1_Channel6->CCR = (1 << 1)            // TCIE: interrupt once the silent record is staged
+                       | (1 << 4)            // DIR: read from memory
+                       | (1 << 7)            // MINC
+                       | (0b10 << 8)         // PSIZE: 32 bits
+                       | (0b10 << 10);       // MSIZE: 32 bits
+    DMA1_Channel6->CCR |= (1 << 0);          // EN
+    NVIC_ISER0 = (1 << DMA1_Channel6_IRQn) | (1 << TIM16_IRQn);
+    last_record = count - 2;
+    dma_playing = 1;
+
+    // Burst of 4 transfers (DBL = 3) starting at PSC (DBA = 0x28 / 4 = 10) on each update event
+    TIM16->DCR = (3 << 8) | 10;
+    TIM16->DIER |= (1 << 8);  // UDE: update event -> DMA request
+
+    // UG: record 0 goes live, and its update event already requests the burst that stages record 1
+    TIM16->EGR |= 1;
+    TIM16->CR1 |= (1 << 0);   // CEN
+}
+
+int song_dma_playing(void) {
+    return dma_playing;
+}
+
+void stop_song_dma(void) {
+    TIM16->DIER &= ~((1 << 8) | (1 << 0));         // UDE and UIE off
+    DMA1_Channel6->CCR &= ~((1 << 0) | (1 << 1));  // Disable the channel and its interrupt
+    DMA1->IFCR = (1 << 20);                        // CGIF6: clear the channel 6 flags
+    dma_playing = 0;
+    if (!PWM_is_click_free()) TIM16->CR1 &= ~(1 << 7); // ARPE off: PWM_frequency() writes ARR directly
+    TIM16->RCR = 0;                  // One update per period again
+    PWM_stop();                      // Silence now: a staged rest would wait out the record's repetitions
+    TIM16->CR1 |= (1 << 0);          // CEN (stays stopped while ARR = 0)
+}
+
+// DMA1 channel 6 transfer complete: the silent record is in the preload registers, so the note that
+// started with this update event is the last one. It ends at the next update event.
+void DMA1_Channel6_IRQHandler(void) {
+    DMA1->IFCR = (1 << 20);   // CGIF6
+    TIM16->SR &= ~(1);        // Clear UIF (set by the update event that requested the transfer)
+    TIM16->DIER |= (1 << 0);  // UIE
+}
+
+// TIM16 update interrupt (vector shared with TIM1 update): the silent record is live, the song is over
+void TIM1_UP_TIM16_IRQHandler(void) {
+    TIM16->SR &= ~(1);        // Clear UIF
+    TIM16->DIER &= ~(1 << 0); // UIE off
+    player_post(PLAYER_SONG_DONE, last_record); // before the flag: see play_cooperatively() in main.c
+    dma_playing = 0;
+}
@@ -0,0 +1,99 @@
+// Filename: PWM_DMA_h
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+// DMA burst playback: a song precompiled into TIM16 register records that DMA1 writes through TIM16->DMAR.
+
+#ifndef PWM_DMA_H
+#define PWM_DMA_H
+
+#include <stdint.h>
+#include "PWM.h"
+#include "STM32L432KC_RCC.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define __IO volatile
+
+// Base addresses
+#define DMA1_BASE          (0x40020000UL)                 // base address of DMA1 in BUS AHB1 p68
+#define DMA1_Channel6_BASE (DMA1_BASE + 0x08 + 20 * 5)    // channel x registers start at 0x08 + 20 * (x - 1)
+#define DMA1_CSELR_BASE    (DMA1_BASE + 0xA8)             // channel request selection register
+
+#define DMA_TIM16_UP_REQ 4 // C6S value that routes TIM16_UP to DMA1 channel 6 (RM0394 table 41)
+
+// NVIC (Cortex-M4 core peripheral, PM0214 4.3)
+#define DMA1_Channel6_IRQn 16 // DMA1 channel 6 global interrupt (RM0394 table 46)
+#define TIM16_IRQn 25         // TIM1_UP_TIM16 global interrupt (RM0394 table 46)
+
+#define PWM_REST_FREQ 1000  // Rests keep TIM16 counting at this rate (with CCR1 = 0) so durations still tick
+#define PWM_MAX_REPEAT 256  // TIM16 repetition counter is 8 bits: a record lasts at most 256 PWM periods
+
+// CHAPTER 11.6: DMA registers p311
+typedef struct
+{
+  __IO uint32_t ISR;          /*!< DMA interrupt status register,                                          Address offset: 0x00 */
+  __IO uint32_t IFCR;         /*!< DMA interrupt flag clear register,                                      Address offset: 0x04 */
+} DMA_TypeDef;
+
+// CHAPTER 11.6: DMA channel x registers p311
+typedef struct
+{
+  __IO uint32_t CCR;          /*!< DMA channel x configuration register,                                   Address offset: 0x00 */
+  __IO uint32_t CNDTR;        /*!< DMA channel x number of data to transfer register,                      Address offset: 0x04 */
+  __IO uint32_t CPAR;         /*!< DMA channel x peripheral address register,                              Address offset: 0x08 */
+  __IO uint32_t CMAR;         /*!< DMA channel x memory address register,                                  Address offset: 0x0C */
+} DMA_Channel_TypeDef;
+
+#if defined(__ARM_ARCH)
+#define DMA1 ((DMA_TypeDef *) DMA1_BASE)
+#define DMA1_Channel6 ((DMA_Channel_TypeDef *) DMA1_Channel6_BASE)
+#define DMA1_CSELR (*(__IO uint32_t *) DMA1_CSELR_BASE)
+#define NVIC_ISER0 (*(__IO uint32_t *) 0xE000E100UL) // Interrupt set-enable register for IRQ 0..31
+#else
+extern DMA_TypeDef sim_DMA1;                      // host build: simulated by the host tools (host/)
+extern DMA_Channel_TypeDef sim_DMA1_Channel6;
+extern uint32_t sim_DMA1_CSELR, sim_NVIC_ISER0;
+#define DMA1 (&sim_DMA1)
+#define DMA1_Channel6 (&sim_DMA1_Channel6)
+#define DMA1_CSELR sim_DMA1_CSELR
+#define NVIC_ISER0 sim_NVIC_ISER0
+#endif
+
+// One note (or part of a long note) as the four TIM16 registers written per burst.
+// Field order matches the register map (PSC 0x28, ARR 0x2C, RCR 0x30, CCR1 0x34) so one burst writes them in a row.
+typedef struct
+{
+  uint32_t psc;  // prescaler, from PWM_psc()
+  uint32_t arr;  // PWM period, from PWM_arr()
+  uint32_t rcr;  // duration: PWM periods - 1 before the next update event (0..255)
+  uint32_t ccr1; // duty: arr / 2 for a note, 0 for a rest
+} pwm_record;
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+/* Precompiles a song into TIM16 register records. Notes longer than PWM_MAX_REPEAT periods
+ * are split into several records, and a silent record is appended so playback ends quietly.
+ *    -- song: {pitch in Hz, duration in ms} pairs (pitch 0 = rest), stops at len or a 0 duration
+ *    -- records, max_records: output buffer
+ *    -- return: number of records written (0 if the buffer is too small) */
+int compile_song(const int (*song)[2], int len, pwm_record * records, int max_records);
+
+/* Plays compiled records with no CPU work per note: each TIM16 update event (end of a record's
+ * repetition count) bursts the next record into PSC/ARR/RCR/CCR1 via DMA1 channel 6 and TIM16->DMAR.
+ * Returns immediately. records must stay valid while playing. The end of the song takes two
+ * interrupts: DMA transfer complete (the last record is staged), then the TIM16 update that loads it.
+ *    -- count: return value of compile_song() (at least 2) */
+void play_song_dma(const pwm_record * records, int count);
+
+/* Returns 1 until the last note is over (the silent record is live), else 0.
+ * The end also posts PLAYER_SONG_DONE to the player event queue (SEQUENCER.h). */
+int song_dma_playing(void);
+
+/* Stops DMA playback, silences the speaker and puts TIM16 back in PWM_frequency() mode */
+void stop_song_dma(void);
+
+#endif
@@ -0,0 +1,262 @@
+// Filename: SEQUENCER.c
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+
+// Plays songs from the TIM15 update interrupt instead of busy-waiting in delaying().
+// Each interrupt ends the current note: the ISR reprograms TIM16 (pitch) and reloads
+// TIM15's ARR with the next duration, so the CPU is free between notes (a note longer than
+// one TIM15 period takes one extra interrupt per period). The ISR also queues a
+// player event that the main loop picks up with player_poll().
+
+#include "SEQUENCER.h"
+
+// Song being played (written by play_song() before the interrupt is enabled, then owned by the ISR)
+static const int (*current_song)[2];     // {Hz, ms} table (play_song()), or
+static const note_regs * current_regs;   // compiled table (play_song_regs()), NULL when unused, or
+static song_reader packed_reader;        // packed song (play_song_packed()), used when packed_reader.song is set, or
+static note_source source;               // note function (play_song_source()), used when set
+static int song_length = 0;
+static volatile int note_index = 0;
+static volatile int playing = 0;
+static volatile uint32_t ticks_left = 0; // TIM15 counts of the current note after the running TIM15 period
+
+playback_control playback = { TEMPO_NORMAL, 0 };
+
+// Event queue: the playing ISR is the only writer of event_head and dropped, player_poll() the only writer
+// of event_tail. Indices run freely and are masked on access, so head - tail is the fill level.
+#define PLAYER_QUEUE_MASK (PLAYER_QUEUE_LEN - 1)
+static volatile player_event events[PLAYER_QUEUE_LEN];
+static volatile uint32_t event_head = 0;
+static volatile uint32_t event_tail = 0;
+static volatile uint32_t dropped = 0;
+static player_handler handler;
+
+// 2^(k/12) and 2^(-k/12) in Q16 for k = 0..11: one semitone step each
+static const uint32_t semitone_up[12] = {
+    65536, 69433, 73562, 77936, 82570, 87480, 92682, 98193, 104032, 110218, 116772, 123715,
+};
+static const uint32_t semitone_down[12] = {
+    65536, 61858, 58386, 55109, 52016, 49097, 46341, 43740, 41285, 38968, 36781, 34716,
+};
+
+// Splits a transposition into whole octaves and 0..11 semitones (floor division)
+static void split_transpose(int semitones, int * octaves, int * step) {
+    *octaves = (semitones >= 0) ? semitones / 12 : -((11 - semitones) / 12);
+    *step = semitones - 12 * *octaves;
+}
+
+// Pitch in Hz after playback.transpose (0 stays a rest). Clamped to 1 Hz, so a deep transposition
+// never turns a note into a rest, and to the 16-bit Hz PWM_PSC_OPT() can take.
+static int transpose_hz(int frequency) {
+    int octaves, step;
+    if (frequency == 0 || playback.transpose == 0) return frequency;
+    split_transpose(playback.transpose, &octaves, &step);
+
+    uint64_t hz = ((uint64_t)frequency * semitone_up[step] + 32768) >> 16;
+    hz = (octaves >= 0) ? (hz << octaves) : ((hz + (1u << (-octaves - 1))) >> -octaves); // rounded
+    if (hz < 1) hz = 1;
+    if (hz > 0xFFFF) hz = 0xFFFF;
+    return (int)hz;
+}
+
+// TIM16 PSC/ARR after playback.transpose: the period (PSC + 1) * (ARR + 1) shrinks as the pitch goes up
+static void transpose_regs(uint32_t * psc, uint32_t * arr) {
+    int octaves, step;
+    if (*arr == 0 || playback.transpose == 0) return;
+    split_transpose(playback.transpose, &octaves, &step);
+
+    uint64_t period = ((uint64_t)(*psc + 1) * (*arr + 1) * semitone_down[step] + 32768) >> 16;
+    period = (octaves >= 0) ? (period >> octaves) : (period << -octaves);
+    if (period < 2) period = 2;
+    if (period > 0xFFFFFFFFUL) period = 0xFFFFFFFFUL;
+    PWM_split((uint32_t)period, psc, arr);
+}
+
+// Loads TIM15's ARR with the next period of the current note: what is left split evenly over the
+// periods it still needs, so no period is longer than the 16-bit ARR or much shorter than the others
+static void next_period(void) {
+    uint32_t periods = (uint32_t)(((uint64_t)ticks_left + 0xFFFF) >> 16);
+    uint32_t ticks = ticks_left / periods;
+    ticks_left -= ticks;
+    TIM15->ARR = ticks - 1;
+}
+
+// Starts a note of the given TIM15 counts after playback.tempo. A note longer than one TIM15 period
+// (65536 counts, ~2.4 s) runs over several: the ISR loads the next one until ticks_left is 0.
+static void start_duration(uint32_t ticks) {
+    uint32_t tempo = playback.tempo ? playback.tempo : 1;
+    uint64_t scaled = ((uint64_t)ticks * TEMPO_NORMAL) / tempo;
+    if (scaled < 1) scaled = 1;
+    if (scaled > 0xFFFFFFFFUL) scaled = 0xFFFFFFFFUL;
+    ticks_left = (uint32_t)scaled;
+    next_period();
+}
+
+// Starts note i: pitch on TIM16, duration as the TIM15 period.
+// Returns 0 (and starts nothing) when the song is over.
+static int start_note(int i) {
+    if (source) {
+        // Notes come from a function (e.g. streamed over USART), i only counts notes
+        int frequency, duration;
+        if (!source(&frequency, &duration)) return 0;
+        PWM_frequency(transpose_hz(frequency));
+        start_duration(delay_ticks(duration));
+        return 1;
+    }
+
+    if (packed_reader.song) {
+        // Packed note: decoded in order, i only counts notes
+        int frequency, duration;
+        if (!song_reader_next(&packed_reader, &frequency, &duration)) return 0;
+        PWM_frequency(transpose_hz(frequency));
+        start_duration(delay_ticks(duration));
+        return 1;
+    }
+
+    if (i >= song_length) return 0;
+
+    if (current_regs) {
+        // Compiled note: plain register writes, unless a tempo or transposition is set
+        if (current_regs[i].reload == 0) return 0;
+        if (playback.transpose == 0) {
+            PWM_set(current_regs[i].psc, current_regs[i].arr, current_regs[i].ccr1);
+        } else {
+            uint32_t psc = current_regs[i].psc, arr = current_regs[i].arr;
+            transpose_regs(&psc, &arr);
+            PWM_set(psc, arr, arr / 2);
+        }
+        if (playback.tempo == TEMPO_NORMAL) {
+            ticks_left = 0;
+            TIM15->ARR = current_regs[i].reload;
+        } else {
+            start_duration(current_regs[i].reload + 1);
+        }
+        return 1;
+    }
+
+    if (current_song[i][1] == 0) return 0;
+
+    PWM_frequency(transpose_hz(current_song[i][0]));
+
+    // ARR preload is off, so the new period applies to the count that just restarted from 0
+    start_duration(delay_ticks(current_song[i][1]));
+    return 1;
+}
+
+// Starts note 0 of whichever table is set and hands the rest to the interrupt
+static void start_song(void) {
+    note_index = 0;
+    if (!start_note(0)) return;
+    playing = 1;
+
+    // Restart TIM15 from 0 with the first note's duration
+    TIM15->CR1 |= (1 << 2);   // URS: only counter overflow raises UIF, not the UG below
+    TIM15->EGR |= 1;          // UG: load ARR and clear the counter
+    TIM15->SR &= ~(1);        // Clear UIF
+    TIM15->DIER |= 1;         // UIE: interrupt when the note's duration is over
+    NVIC_ISER0 = (1 << TIM15_IRQn);
+    TIM15->CR1 |= 1;          // CEN
+}
+
+void play_song(const int (*song)[2], int len) {
+    stop_song(); // no interrupt can touch the song state while it is replaced
+    current_song = song;
+    current_regs = 0;
+    packed_reader.song = 0;
+    source = 0;
+    song_length = len;
+    start_song();
+}
+
+void play_song_regs(const note_regs * song, int len) {
+    stop_song();
+    current_regs = song;
+    packed_reader.song = 0;
+    source = 0;
+    song_length = len;
+    start_song();
+}
+
+void play_song_packed(const packed_song * song) {
+    stop_song();
+    source = 0;
+    song_reader_start(&packed_reader, song);
+    start_song();
+}
+
+void play_song_source(note_source next) {
+    stop_song();
+    source = next;
+    start_song();
+}
+
+int song_playing(void) {
+    return playing;
+}
+
+void stop_song(void) {
+    TIM15->DIER &= ~(1); // UIE off: no more note changes
+    TIM15->SR &= ~(1);   // drop a pending update
+    PWM_frequency(0);
+    playing = 0;
+    ticks_left = 0;
+}
+
+void player_post(uint8_t type, int note) {
+    uint32_t head = event_head;
+    if (head - event_tail >= PLAYER_QUEUE_LEN) {
+        dropped++;
+        return;
+    }
+    events[head & PLAYER_QUEUE_MASK].type = type;
+    events[head & PLAYER_QUEUE_MASK].note = (uint16_t)note;
+    event_head = head + 1; // publish after the event is written
+}
+
+void player_on_event(player_handler on_event) {
+    handler = on_event;
+}
+
+int player_poll(void) {
+    uint32_t tail = event_tail;
+    while (tail != event_head) {
+        player_event event;
+        event.type = events[tail & PLAYER_QUEUE_MASK].type;
+        event.note = events[tail & PLAYER_QUEUE_MASK].note;
+        event_tail = ++tail; // hand the slot back before the callback, which may start a new song
+        if (handler) handler(&event);
+    }
+    return playing || event_tail != event_head;
+}
+
+void player_wait(void) {
+#if defined(__ARM_ARCH)
+    // With PRIMASK set a pending interrupt still ends WFI; it runs once interrupts are enabled again
+    __asm volatile ("cpsid i");
+    if (event_tail == event_head) __asm volatile ("wfi");
+    __asm volatile ("cpsie i");
+#endif
+}
+
+uint32_t player_dropped(void) {
+    return dropped;
+}
+
+// TIM15 update interrupt (vector shared with TIM1 break): the current note is over
+void TIM1_BRK_TIM15_IRQHandler(void) {
+    TIM15->SR &= ~(1); // Clear UIF
+
+    // A long note is only over after its last TIM15 period
+    if (ticks_left) {
+        next_period();
+        return;
+    }
+
+    note_index++;
+    if (start_note(note_index)) {
+        player_post(PLAYER_NOTE_DONE, note_index - 1);
+    } else {
+        stop_song();
+        player_post(PLAYER_SONG_DONE, note_index - 1);
+    }
+}
@@ -0,0 +1,122 @@
+// Filename: SEQUENCER_h
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+// Interrupt-driven note sequencer: TIM15's update interrupt steps through a song in the background.
+
+#ifndef SEQUENCER_H
+#define SEQUENCER_H
+
+#include <stdint.h>
+#include "TIMER.h"
+#include "PWM.h"
+#include "PACKED_SONG.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define __IO volatile
+
+// NVIC (Cortex-M4 core peripheral, PM0214 4.3)
+#if defined(__ARM_ARCH)
+#define NVIC_ISER0 (*(__IO uint32_t *) 0xE000E100UL) // Interrupt set-enable register for IRQ 0..31
+#else
+extern uint32_t sim_NVIC_ISER0;                      // host build: simulated by the host tools (host/)
+#define NVIC_ISER0 sim_NVIC_ISER0
+#endif
+#define TIM15_IRQn 24                                  // TIM1_BRK_TIM15 global interrupt (RM0394 table 46)
+
+// One note as the register values the sequencer writes (all computed at compile time by NOTE_REGS)
+typedef struct
+{
+  uint16_t psc;    // TIM16 PSC, picked per note by PWM_PSC_OPT()
+  uint16_t arr;    // TIM16 ARR (0 = rest)
+  uint16_t ccr1;   // TIM16 CCR1 (arr / 2)
+  uint16_t reload; // TIM15 ARR for the duration (0 = end of song)
+} note_regs;
+
+// Builds a note_regs initializer from a pitch in Hz and a duration in ms; the build fails if the duration overflows
+// (the per-note PSC keeps ARR within 16 bits for every pitch)
+#define NOTE_REGS(hz, ms) {PWM_PSC_OPT(hz), PWM_ARR_OPT(hz), PWM_ARR_OPT(hz) / 2, (ms) == 0 ? 0 : DELAY_TICKS_CHECKED(ms) - 1},
+
+// Playback controls, read by the interrupt at every note, so they can change while a song plays.
+// They apply to every sequencer source (play_song*()), not to DMA playback.
+#define TEMPO_NORMAL 256 // tempo is Q8.8: 256 = durations as written, 512 = twice as fast, 128 = half speed
+typedef struct
+{
+  volatile uint16_t tempo;    // speed multiplier, Q8.8 (1..65535); durations become ms * 256 / tempo
+  volatile int8_t transpose;  // semitones, + = higher; any value plays (the per-note PSC fits ARR, pitches clamp to 1..65535 Hz)
+} playback_control;
+
+extern playback_control playback;
+
+// Player events. The TIM15 interrupt (and the DMA player's, PWM_DMA.c) only queues them; player_poll(),
+// called from the main loop, hands them to the event callback, so other work never has to wait on the
+// player (cooperative scheduling).
+#define PLAYER_QUEUE_LEN 16 // queued events, must be a power of 2
+#define PLAYER_NOTE_DONE 0  // a note is over and the next one has started
+#define PLAYER_SONG_DONE 1  // the last note is over and the player stopped (not sent by stop_song*())
+typedef struct
+{
+  uint8_t type;   // PLAYER_NOTE_DONE or PLAYER_SONG_DONE
+  uint16_t note;  // index in the song of the note that ended (DMA playback: of the last record)
+} player_event;
+
+typedef void (*player_handler)(const player_event * event);
+
+// Any note producer (e.g. stream_next() in SONG_STREAM.h), called from the interrupt once per note:
+// sets the pitch in Hz (0 = rest) and the duration in ms, returns 0 when the song is over
+typedef int (*note_source)(int * frequency, int * duration);
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+/* Starts playing a song in the background and returns immediately.
+ * The first note starts now; each TIM15 update interrupt then moves to the next one.
+ * Playback stops after len notes or at a note whose duration is 0.
+ *    -- song: {pitch in Hz, duration in ms} pairs (pitch 0 = rest); must stay valid while playing
+ *    -- len: number of notes in song */
+void play_song(const int (*song)[2], int len);
+
+/* Same as play_song() for a table compiled with NOTE_REGS: the interrupt only copies register values.
+ * Playback stops after len notes or at a note whose reload is 0. */
+void play_song_regs(const note_regs * song, int len);
+
+/* Same as play_song() for a packed song: the interrupt decodes one 16-bit note word per note.
+ *    -- song: must stay valid while playing */
+void play_song_packed(const packed_song * song);
+
+/* Same as play_song() with notes pulled from a function, for songs that are not in flash
+ *    -- next: called once per note from the TIM15 interrupt; must be quick */
+void play_song_source(note_source next);
+
+/* Returns 1 while a song started by play_song() is still playing, else 0 */
+int song_playing(void);
+
+/* Silences the speaker and stops the sequencer */
+void stop_song(void);
+
+/* Queues an event for player_poll(), from an interrupt of a player (the sequencer or the DMA player;
+ * only one plays at a time, so the queue keeps a single writer). A full queue counts it as dropped.
+ *    -- type: PLAYER_NOTE_DONE or PLAYER_SONG_DONE
+ *    -- note: index of the note that ended */
+void player_post(uint8_t type, int note);
+
+/* Sets the function player_poll() calls for every event (NULL: events are discarded) */
+void player_on_event(player_handler handler);
+
+/* Hands every queued event to the event callback, oldest first, and returns without waiting.
+ * The callback runs in the caller's context, so it may start the next song or take its time.
+ *    -- return: 1 while a sequencer song is playing or events are still queued, else 0
+ *       (DMA playback: check song_dma_playing() too) */
+int player_poll(void);
+
+/* Sleeps until the next interrupt, unless an event is already queued (an event posted between
+ * player_poll() and the sleep is never missed). Returns at once in the host build. */
+void player_wait(void);
+
+/* Returns how many events were dropped because player_poll() fell PLAYER_QUEUE_LEN events behind */
+uint32_t player_dropped(void);
+
+#endif
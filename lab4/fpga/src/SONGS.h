@@ -0,0 +1,180 @@
+// Filename: SONGS_h
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+// Song tables as note lists: each song is a macro that calls N(note name, duration in ms) once per note.
+// Note names come from PITCHES.h (REST = silence). main.c expands the same list several times at
+// compile time: into {Hz, ms} pairs, into ready-to-write TIM16/TIM15 register values (NOTE_REGS in
+// SEQUENCER.h) and into 16-bit packed notes (NOTE_PACKED in PACKED_SONG.h).
+// Every duration must be a multiple of the song's tempo base (its packed time unit).
+// Polyphonic songs call C(duration in ms, voice 0, voice 1, voice 2, voice 3) per step instead
+// (POLY_STEP in POLY_SONG.h); HOLD keeps a voice's note from the step before, and each
+// polyphonic song names one instrument envelope per voice.
+
+#ifndef SONGS_H
+#define SONGS_H
+
+#include "PITCHES.h"
+
+// Fur Elise
+#define FUR_ELISE_TEMPO 125 // ms per packed time unit
+#define FUR_ELISE_SONG(N) \
+    N(E5, 125)   \
+    N(DS5, 125)  \
+    N(E5, 125)   \
+    N(DS5, 125)  \
+    N(E5, 125)   \
+    N(B4, 125)   \
+    N(D5, 125)   \
+    N(C5, 125)   \
+    N(A4, 250)   \
+    N(REST, 125) \
+    N(C4, 125)   \
+    N(E4, 125)   \
+    N(A4, 125)   \
+    N(B4, 250)   \
+    N(REST, 125) \
+    N(E4, 125)   \
+    N(GS4, 125)  \
+    N(B4, 125)   \
+    N(C5, 250)   \
+    N(REST, 125) \
+    N(E4, 125)   \
+    N(E5, 125)   \
+    N(DS5, 125)  \
+    N(E5, 125)   \
+    N(DS5, 125)  \
+    N(E5, 125)   \
+    N(B4, 125)   \
+    N(D5, 125)   \
+    N(C5, 125)   \
+    N(A4, 250)   \
+    N(REST, 125) \
+    N(C4, 125)   \
+    N(E4, 125)   \
+    N(A4, 125)   \
+    N(B4, 250)   \
+    N(REST, 125) \
+    N(E4, 125)   \
+    N(C5, 125)   \
+    N(B4, 125)   \
+    N(A4, 250)   \
+    N(REST, 125) \
+    N(B4, 125)   \
+    N(C5, 125)   \
+    N(D5, 125)   \
+    N(E5, 375)   \
+    N(G4, 125)   \
+    N(F5, 125)   \
+    N(E5, 125)   \
+    N(D5, 375)   \
+    N(F4, 125)   \
+    N(E5, 125)   \
+    N(D5, 125)   \
+    N(C5, 375)   \
+    N(E4, 125)   \
+    N(D5, 125)   \
+    N(C5, 125)   \
+    N(B4, 250)   \
+    N(REST, 125) \
+    N(E4, 125)   \
+    N(E5, 125)   \
+    N(REST, 250) \
+    N(E5, 125)   \
+    N(E6, 125)   \
+    N(REST, 250) \
+    N(DS5, 125)  \
+    N(E5, 125)   \
+    N(REST, 250) \
+    N(DS5, 125)  \
+    N(E5, 125)   \
+    N(DS5, 125)  \
+    N(E5, 125)   \
+    N(DS5, 125)  \
+    N(E5, 125)   \
+    N(B4, 125)   \
+    N(D5, 125)   \
+    N(C5, 125)   \
+    N(A4, 250)   \
+    N(REST, 125) \
+    N(C4, 125)   \
+    N(E4, 125)   \
+    N(A4, 125)   \
+    N(B4, 250)   \
+    N(REST, 125) \
+    N(E4, 125)   \
+    N(GS4, 125)  \
+    N(B4, 125)   \
+    N(C5, 250)   \
+    N(REST, 125) \
+    N(E4, 125)   \
+    N(E5, 125)   \
+    N(DS5, 125)  \
+    N(E5, 125)   \
+    N(DS5, 125)  \
+    N(E5, 125)   \
+    N(B4, 125)   \
+    N(D5, 125)   \
+    N(C5, 125)   \
+    N(A4, 250)   \
+    N(REST, 125) \
+    N(C4, 125)   \
+    N(E4, 125)   \
+    N(A4, 125)   \
+    N(B4, 250)   \
+    N(REST, 125) \
+    N(E4, 125)   \
+    N(C5, 125)   \
+    N(B4, 125)   \
+    N(A4, 500)   \
+    N(REST, 500) \
+    N(REST, 500)
+
+// Minecraft "Sweden" by C418
+// Note name, duration in ms as written; slow it down at run time with playback.tempo (SEQUENCER.h)
+// Target: Much slower, more accurate to original - very calm and peaceful
+#define MINECRAFT_TEMPO 100 // ms per packed time unit
+#define MINECRAFT_NOTES(N) \
+    /* Main melody - very slow and peaceful (slow it further with playback.tempo, e.g. 26 = 9.8x slower) */ \
+    N(F4, 200) N(G4, 200) N(E4, 200) N(D4, 200) N(E4, 200) N(G4, 200) N(C5, 400)               \
+    N(REST, 100)                                                                               \
+    N(F4, 200) N(G4, 200) N(E4, 200) N(D4, 200) N(E4, 100) N(D4, 100) N(C4, 400)               \
+    N(REST, 200)                                                                               \
+    N(F4, 200) N(G4, 200) N(E4, 200) N(D4, 200) N(E4, 200) N(G4, 200) N(C5, 400)               \
+    N(REST, 100)                                                                               \
+    N(D5, 200) N(C5, 200) N(B4, 200) N(A4, 200) N(B4, 200) N(C5, 400)                          \
+    N(REST, 200)                                                                               \
+                                                                                               \
+    /* Second part */                                                                          \
+    N(F4, 200) N(G4, 200) N(E4, 200) N(D4, 200) N(E4, 200) N(G4, 200) N(C5, 400)               \
+    N(REST, 100)                                                                               \
+    N(F4, 200) N(G4, 200) N(E4, 200) N(D4, 200) N(E4, 100) N(D4, 100) N(C4, 400)               \
+    N(REST, 200)                                                                               \
+                                                                                               \
+    /* Variation */                                                                            \
+    N(G4, 200) N(A4, 200) N(F4, 200) N(E4, 200) N(F4, 200) N(A4, 200) N(D5, 400)               \
+    N(REST, 100)                                                                               \
+    N(G4, 200) N(A4, 200) N(F4, 200) N(E4, 200) N(F4, 100) N(E4, 100) N(D4, 400)               \
+    N(REST, 200)                                                                               \
+                                                                                               \
+    /* Ending phrase */                                                                        \
+    N(F4, 200) N(G4, 200) N(E4, 200) N(D4, 200) N(E4, 200) N(G4, 200) N(C5, 400)               \
+    N(REST, 100)                                                                               \
+    N(D5, 200) N(C5, 200) N(B4, 200) N(A4, 200) N(B4, 400) N(A4, 400)                          \
+    N(REST, 0)
+
+// Chord progression C - Am - F - G: melody on voice 0, each chord held under it on voices 1..3
+// Envelopes per voice (INSTRUMENT_* in ENVELOPE.h): plucked melody over a soft pad
+#define CHORD_DEMO_VOICES { INSTRUMENT_PLUCK, INSTRUMENT_PAD, INSTRUMENT_PAD, INSTRUMENT_PAD }
+#define CHORD_DEMO(C) \
+    C(250, E5, C4, E4, G4)         C(250, G5, HOLD, HOLD, HOLD)   \
+    C(250, E5, HOLD, HOLD, HOLD)   C(250, C5, HOLD, HOLD, HOLD)   \
+    C(250, E5, A3, C4, E4)         C(250, A5, HOLD, HOLD, HOLD)   \
+    C(250, E5, HOLD, HOLD, HOLD)   C(250, C5, HOLD, HOLD, HOLD)   \
+    C(250, F5, F3, A3, C4)         C(250, A5, HOLD, HOLD, HOLD)   \
+    C(250, F5, HOLD, HOLD, HOLD)   C(250, C5, HOLD, HOLD, HOLD)   \
+    C(250, D5, G3, B3, D4)         C(250, G5, HOLD, HOLD, HOLD)   \
+    C(250, B4, HOLD, HOLD, HOLD)   C(250, D5, HOLD, HOLD, HOLD)   \
+    C(1000, C5, C4, E4, G4)                                       \
+    C(0, REST, REST, REST, REST)
+
+#endif
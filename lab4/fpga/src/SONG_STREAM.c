@@ -0,0 +1,125 @@
+// Filename: SONG_STREAM.c
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+
+// Streams packed notes from USART2 into two buffer halves. The USART2 receive callback fills one
+// half while the sequencer's TIM15 interrupt plays the other through stream_next(). A half that has
+// been played is handed back to the receiver, and a credit byte tells the host it may send the next
+// block. Both interrupts run at the same priority, so neither preempts the other. The stream runs
+// on from one song to the next: only init_stream() resets the halves and the credits.
+
+#include "SONG_STREAM.h"
+
+static uint16_t buffer[2][STREAM_HALF];
+static volatile uint8_t count[2];   // notes in a full half
+static volatile uint8_t full[2];    // 1 = half received, owned by the player; 0 = owned by the receiver
+
+// Receiver side (USART2 interrupt)
+static uint8_t fill_half = 0;
+static uint8_t fill_pos = 0;
+static int high_byte = -1;          // first byte of a note word, -1 when none yet
+
+// Player side (TIM15 interrupt)
+static uint8_t play_half = 0;
+static uint8_t play_pos = 0;
+static uint16_t tempo = 0;
+
+static volatile uint8_t credits = 0; // credit bytes still to send
+static volatile uint32_t underruns = 0;
+static volatile uint32_t overruns = 0;
+static uint32_t usart_overruns_at_start = 0;
+
+// Transmit callback: one credit byte while any are owed
+static int next_credit(uint8_t * byte) {
+    if (credits == 0) return 0;
+    credits--;
+    *byte = STREAM_CREDIT;
+    return 1;
+}
+
+// Queues one credit byte; the transmit-empty interrupt sends it
+static void grant_credit(void) {
+    credits++;
+    USART_transmit(next_credit);
+}
+
+// Hands the half being filled to the player
+static void close_block(void) {
+    count[fill_half] = fill_pos;
+    fill_pos = 0;
+    full[fill_half] = 1;
+    fill_half ^= 1;
+}
+
+// Receive callback: two bytes make a note word; a full half, an end-of-song note or
+// STREAM_BLOCK_END closes a block
+static void receive_byte(uint8_t byte) {
+    if (full[fill_half]) {
+        overruns++;             // host sent without a credit: drop the byte
+    } else if (high_byte < 0) {
+        high_byte = byte;
+    } else {
+        uint16_t note = PACK_NOTE(high_byte, byte);
+        high_byte = -1;
+        if (note == STREAM_BLOCK_END) {
+            if (fill_pos) close_block();
+            else grant_credit(); // empty block: nothing to play, the half is still free
+            return;
+        }
+        buffer[fill_half][fill_pos++] = note;
+        if (fill_pos == STREAM_HALF || PACKED_UNITS(note) == 0) close_block();
+    }
+}
+
+void init_stream(void){
+    initUSART(STREAM_BAUD);
+    full[0] = full[1] = 0;
+    fill_half = play_half = 0;
+    fill_pos = play_pos = 0;
+    high_byte = -1;
+    usart_overruns_at_start = USART_overruns();
+    credits = 2;              // both halves are empty
+    USART_on_receive(receive_byte);
+    USART_transmit(next_credit);
+}
+
+void stream_start(uint16_t tempo_ms){
+    // The end note of the last song closed its block, so the player is at the start of a half:
+    // whatever the host sent since then is the start of this song
+    tempo = tempo_ms;
+    underruns = 0;
+    overruns = 0;
+    usart_overruns_at_start = USART_overruns();
+}
+
+int stream_next(int * frequency, int * duration){
+    if (!full[play_half]) {
+        // Next block is late: wait one tempo unit in silence instead of ending the song
+        underruns++;
+        *frequency = 0;
+        *duration = tempo;
+        return 1;
+    }
+
+    uint16_t note = buffer[play_half][play_pos++];
+    if (play_pos >= count[play_half]) {
+        // Half played: give it back to the receiver and ask the host for the next block
+        play_pos = 0;
+        full[play_half] = 0;
+        play_half ^= 1;
+        grant_credit();
+    }
+
+    if (PACKED_UNITS(note) == 0) return 0; // end of song
+    *frequency = pitch_hz(PACKED_MIDI(note));
+    *duration = PACKED_UNITS(note) * tempo;
+    return 1;
+}
+
+uint32_t stream_underruns(void){
+    return underruns;
+}
+
+uint32_t stream_overruns(void){
+    return overruns + (USART_overruns() - usart_overruns_at_start);
+}
@@ -0,0 +1,54 @@
+// Filename: SONG_STREAM_h
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+// Song streaming over USART2: packed notes arrive into a ping-pong buffer while the sequencer plays the other half.
+
+#ifndef SONG_STREAM_H
+#define SONG_STREAM_H
+
+#include <stdint.h>
+#include "PACKED_SONG.h"
+#include "STM32L432KC_USART.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+// Protocol (host -> board): packed note words (PACK_NOTE(), high byte first), in blocks of at most
+// STREAM_HALF notes. A block ends after STREAM_HALF notes, at a note with 0 units (end of song), or
+// at a STREAM_BLOCK_END word, which is not a note: every shorter block must end with one. Songs
+// follow each other on the same stream, the next one starting with the block after the end note.
+// Backpressure (board -> host): the board sends one STREAM_CREDIT byte per free half. The host sends
+// exactly one block per credit, so it never overruns the buffer. Two credits are sent by
+// init_stream(); from then on every credit is for a half the player has finished with.
+#define STREAM_HALF 64        // notes per buffer half: 2 x 64 x 2 bytes = 256 bytes of RAM
+#define STREAM_CREDIT 'R'     // "ready for one more block"
+#define STREAM_BLOCK_END PACK_NOTE(0xFF, 0) // closes a short block (an empty one hands its credit back)"
+#define STREAM_BAUD 115200    // 5760 notes/s, far above any tempo
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+/* Sets up USART2 (initUSART()) at STREAM_BAUD, empties both buffer halves, takes over the receive
+ * and transmit interrupts and sends the host two credits */
+void init_stream(void);
+
+/* Starts the next streamed song and clears the underrun/overrun counts. Keeps the buffer and the
+ * host's credits: the song's first blocks may already have arrived while the last one played.
+ *    -- tempo_ms: duration of one packed time unit for the streamed song */
+void stream_start(uint16_t tempo_ms);
+
+/* Decodes the next streamed note (the sequencer calls this from its interrupt). When the next
+ * block has not arrived yet it returns a rest of one tempo unit and counts an underrun.
+ *    -- frequency, duration: set to the pitch in Hz (0 = rest) and the duration in ms
+ *    -- return: 1 if a note was produced, 0 once the end-of-song note was played */
+int stream_next(int * frequency, int * duration);
+
+/* Returns how many rests were inserted because the host was late */
+uint32_t stream_underruns(void);
+
+/* Returns how many bytes were lost: sent without a credit, or overrun in the USART */
+uint32_t stream_overruns(void);
+
+#endif
@@ -71,7 +71,12 @@ typedef struct
   __IO uint32_t CRRCR;       /*!< RCC clock recovery RC register,                                          Address offset: 0x98 */
 } RCC_TypeDef;
 
+#if defined(__ARM_ARCH)
 #define RCC ((RCC_TypeDef *) RCC_BASE)
+#else
+extern RCC_TypeDef sim_RCC; // host build: simulated by the host tools
+#define RCC (&sim_RCC)
+#endif
 
 ///////////////////////////////////////////////////////////////////////////////
 // Function prototypes
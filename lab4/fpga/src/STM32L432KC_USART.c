@@ -0,0 +1,63 @@
+// STM32L432KC_USART.c
+// Source code for USART2 functions: interrupt-driven receive and transmit through callbacks
+
+#include "STM32L432KC_USART.h"
+#include "STM32L432KC_RCC.h"
+#include "STM32L432KC_GPIO.h"
+
+static void (*volatile receive_handler)(uint8_t byte);
+static int (*volatile transmit_next)(uint8_t * byte);
+static volatile uint32_t overruns = 0;
+
+void initUSART(int baud_rate){
+    // Enable USART2 clock (APB1ENR1 bit 17); it runs from PCLK1 = 80 MHz (CCIPR USART2SEL = 00)
+    RCC->APB1ENR1 |= (1 << 17); // USART2EN
+
+    // PA2 = USART2_TX (AF7), PA15 = USART2_RX (AF3)
+    pinMode(2, GPIO_ALT);
+    pinMode(15, GPIO_ALT);
+    GPIO->AFRL = (GPIO->AFRL & ~(0xF << (2 * 4))) | (7 << (2 * 4));
+    GPIO->AFRH = (GPIO->AFRH & ~(0xFU << ((15 - 8) * 4))) | (3U << ((15 - 8) * 4));
+
+    // 8 data bits, 1 stop bit, oversampling by 16 (reset values)
+    USART2->CR1 &= ~(1 << 0);              // UE off while BRR changes
+    USART2->BRR = 80000000 / baud_rate;
+    USART2->CR1 |= (1 << 5);               // RXNEIE: one interrupt per received byte
+    USART2->CR1 |= (1 << 3) | (1 << 2);    // TE, RE
+    USART2->CR1 |= (1 << 0);               // UE
+    NVIC_ISER1 = (1 << (USART2_IRQn - 32));
+}
+
+void USART_on_receive(void (*handler)(uint8_t byte)){
+    receive_handler = handler;
+}
+
+void USART_transmit(int (*next)(uint8_t * byte)){
+    transmit_next = next;
+    USART2->CR1 |= (1 << 7); // TXEIE: the interrupt pulls bytes while TDR is empty
+}
+
+uint32_t USART_overruns(void){
+    return overruns;
+}
+
+// USART2 interrupt: a received byte and/or room to send one
+void USART2_IRQHandler(void){
+    uint32_t isr = USART2->ISR;
+
+    if (isr & (1 << 3)) {           // ORE: a byte was lost in hardware
+        USART2->ICR = (1 << 3);     // ORECF
+        overruns++;
+    }
+
+    if (isr & (1 << 5)) {           // RXNE (reading RDR clears it)
+        uint8_t byte = USART2->RDR;
+        if (receive_handler) receive_handler(byte);
+    }
+
+    if ((USART2->CR1 & (1 << 7)) && (isr & (1 << 7))) { // TXEIE and TXE
+        uint8_t byte;
+        if (transmit_next && transmit_next(&byte)) USART2->TDR = byte;
+        else USART2->CR1 &= ~(1 << 7);                   // nothing left to send
+    }
+}
@@ -0,0 +1,65 @@
+// STM32L432KC_USART.h
+// Header for USART2 functions (register-level port of the lab6 USART driver, interrupt driven)
+
+#ifndef STM32L4_USART_H
+#define STM32L4_USART_H
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define __IO volatile
+
+// Base addresses
+#define USART2_BASE (0x40004400UL) // base address of USART2 in BUS APB1 p68 (ST-LINK virtual COM port)
+
+// NVIC (Cortex-M4 core peripheral, PM0214 4.3)
+#define USART2_IRQn 38                                // USART2 global interrupt (RM0394 table 46)
+
+// CHAPTER 36.8: USART registers
+typedef struct
+{
+  __IO uint32_t CR1;          /*!< USART control register 1,                                               Address offset: 0x00 */
+  __IO uint32_t CR2;          /*!< USART control register 2,                                               Address offset: 0x04 */
+  __IO uint32_t CR3;          /*!< USART control register 3,                                               Address offset: 0x08 */
+  __IO uint32_t BRR;          /*!< USART baud rate register,                                               Address offset: 0x0C */
+  __IO uint32_t GTPR;         /*!< USART guard time and prescaler register,                                Address offset: 0x10 */
+  __IO uint32_t RTOR;         /*!< USART receiver timeout register,                                        Address offset: 0x14 */
+  __IO uint32_t RQR;          /*!< USART request register,                                                 Address offset: 0x18 */
+  __IO uint32_t ISR;          /*!< USART interrupt and status register,                                    Address offset: 0x1C */
+  __IO uint32_t ICR;          /*!< USART interrupt flag clear register,                                    Address offset: 0x20 */
+  __IO uint32_t RDR;          /*!< USART receive data register,                                            Address offset: 0x24 */
+  __IO uint32_t TDR;          /*!< USART transmit data register,                                           Address offset: 0x28 */
+} USART_TypeDef;
+
+#if defined(__ARM_ARCH)
+#define USART2 ((USART_TypeDef *) USART2_BASE)
+#define NVIC_ISER1 (*(__IO uint32_t *) 0xE000E104UL) // Interrupt set-enable register for IRQ 32..63
+#else
+extern USART_TypeDef sim_USART2;                     // host build: simulated by the host tools
+extern uint32_t sim_NVIC_ISER1;
+#define USART2 (&sim_USART2)
+#define NVIC_ISER1 sim_NVIC_ISER1
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+/* Sets up USART2 on PA2 (TX) / PA15 (RX), 8N1, with one receive interrupt per byte
+ *    -- baud_rate: e.g. 115200, or 31250 for MIDI */
+void initUSART(int baud_rate);
+
+/* Selects the function the receive interrupt hands every byte to (interrupt context, keep it short) */
+void USART_on_receive(void (*handler)(uint8_t byte));
+
+/* Selects the function the transmit interrupt asks for the next byte (returns 0 when there is none)
+ * and starts transmitting; call again to restart after it returned 0 */
+void USART_transmit(int (*next)(uint8_t * byte));
+
+/* Returns how many received bytes the hardware lost (overrun errors) */
+uint32_t USART_overruns(void);
+
+#endif
@@ -32,16 +32,18 @@ void init_delaying() {
 
 }
 
-void delaying(int song_waiting){
+uint32_t delay_ticks(int song_waiting){
+
+    // Timer counts TIM15_CLK times per second (~26.7 kHz if PSC_div=3000)
+    // song_waiting assumed in milliseconds
+    return DELAY_TICKS(song_waiting);
+}
 
-    // Calculate the timer frequency after prescaler
-    uint32_t tim15_clk = 80000000 / (PSC_div + 1);
-    // Timer counts tim15_clk times per second (~26.7 kHz if PSC_div=3000)
+void delaying(int song_waiting){
 
     // Calculate the max counter value needed to achieve the desired delay
-    // song_waiting assumed in milliseconds
     // ARR = (timer_freq_in_kHz * delay_ms) - 1
-    uint32_t counter_max_val = ((tim15_clk / 1000) * song_waiting) - 1;
+    uint32_t counter_max_val = delay_ticks(song_waiting) - 1;
 
     // Reset the counter to 0
     TIM15->CNT = 0; // CNT
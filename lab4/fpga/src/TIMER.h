@@ -27,6 +27,14 @@
 // Original timer runs extremely fast (~80 MHz). With PSC_div=3000, so TIM15 counter ticks ~26.7 kHz.
 // Makes it easier to use for delays in software.
 
+// Compile-time version of delay_ticks(), for constant note tables
+// TIM15 counts at 80 MHz / PSC_div (PSC = PSC_div - 1), 26.67 counts per ms: the count is rounded,
+// so a note is off by at most half a count (19 us). 32-bit math holds up to ~53 s.
+#define TIM15_CLK (80000000 / PSC_div)                 // TIM15 counter rate as used by delaying()
+#define DELAY_TICKS(ms) (((uint32_t)(ms) * (80000000UL / 1000) + PSC_div / 2) / PSC_div) // counts for a duration in ms
+// Same value, but the build fails (negative array size) if ARR = ticks - 1 does not fit 16 bits
+#define DELAY_TICKS_CHECKED(ms) (DELAY_TICKS(ms) + 0 * sizeof(char[DELAY_TICKS(ms) <= 0x10000 ? 1 : -1]))
+
 
 /**
   * @brief Reset and Clock Control
@@ -62,7 +70,12 @@ typedef struct
   uint32_t      OR2;          /*!< TIM15 option register 2 (TIM15_OR2),                                    Address offset: 0x60 */
 } TIM15_TypeDef;
 
+#if defined(__ARM_ARCH)
 #define TIM15 ((TIM15_TypeDef *) TIM15_BASE)
+#else
+extern TIM15_TypeDef sim_TIM15;  // host build: register block simulated by the host tools (host/)
+#define TIM15 (&sim_TIM15)
+#endif
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -72,4 +85,9 @@ typedef struct
 void init_delaying(void);
 void delaying(int song_waiting);
 
+/* Converts a duration to TIM15 counts (prescaled by PSC_div)
+ *    -- song_waiting: duration in ms (up to ~2400 ms so the count fits the 16-bit ARR)
+ *    -- return: number of counts, ARR = return - 1 */
+uint32_t delay_ticks(int song_waiting);
+
 #endif
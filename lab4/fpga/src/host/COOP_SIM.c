@@ -0,0 +1,300 @@
+// Filename: COOP_SIM.c
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+
+// Host-side simulation of lab4 playback sharing the CPU with the lab6 sensor/web loop. Links the real
+// SEQUENCER.c (TIM15 interrupt, player events), PWM.c, TIMER.c and PACKED_SONG.c against simulated
+// registers and runs one CPU in 80 MHz core cycles:
+//    -- the TIM15 interrupt preempts whatever runs and costs isr_cycles
+//    -- the main loop is play_cooperatively() from main.c with one step of other work added:
+//       player_poll(), the step, player_wait(); the event callback starts the next song of the
+//       playlist on PLAYER_SONG_DONE
+//    -- the other work is the lab6 request loop as one step: if a web request has arrived, change
+//       the DS1722 resolution (75..900 ms conversion wait, or none for the LED buttons) and send the
+//       1093-byte page at 125000 baud (87.5 ms); otherwise return
+// The same request arrivals are replayed three times:
+//    idle:        no song, the sensor loop alone (the latency it should keep)
+//    cooperative: both songs play through the player events while the loop runs
+//    blocking:    the old main.c, which slept in while (song_playing()) until the songs were over
+// Reported: request response latency (request received -> page sent), event delivery latency
+// (interrupt -> callback), deepest event queue, and how long each song lasts, which must not change.
+// The next song starts from the callback, so the gap between songs grows by the event delivery time.
+// On the board lab6's delay_millis() would need a timer other than TIM15, which plays the notes.
+//
+// Build and run from lab4/fpga/src:
+//    gcc -O2 -I. -o coop_sim host/COOP_SIM.c SEQUENCER.c PWM.c TIMER.c PACKED_SONG.c PITCHES.c -lm
+//    ./coop_sim
+//
+// Usage: coop_sim [mean_request_ms] [isr_cycles] [seed]
+//    -- mean_request_ms: mean time between web requests (random arrivals), 2000 by default
+//    -- isr_cycles: cost of one TIM15 interrupt including entry and exit, 400 by default
+//    -- seed: random request seed
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "PWM.h"
+#include "TIMER.h"
+#include "SEQUENCER.h"
+#include "PACKED_SONG.h"
+#include "SONGS.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define CORE_HZ 80000000ULL
+#define MS (CORE_HZ / 1000)
+#define PAGE_BYTES 1093                     // lab6 page: header, buttons, temperature and LED status
+#define USART_BYTE_CYCLES (CORE_HZ * 10 / 125000) // lab6 ESP link, 10 bits per byte
+#define POLL_CYCLES 60                      // player_poll() and the callback, per event
+#define MAX_REQUESTS 4096
+#define NEVER UINT64_MAX
+
+// Same packed songs as main.c
+#define FUR_ELISE_PACKED(name, ms) NOTE_PACKED(name, ms, FUR_ELISE_TEMPO)
+#define MINECRAFT_PACKED(name, ms) NOTE_PACKED(name, ms, MINECRAFT_TEMPO)
+static const uint16_t fur_elise_notes[] = { FUR_ELISE_SONG(FUR_ELISE_PACKED) };
+static const uint16_t minecraft_packed_notes[] = { MINECRAFT_NOTES(MINECRAFT_PACKED) };
+static const packed_song fur_elise_packed = { FUR_ELISE_TEMPO, sizeof(fur_elise_notes) / sizeof(fur_elise_notes[0]), fur_elise_notes };
+static const packed_song minecraft_packed = { MINECRAFT_TEMPO, sizeof(minecraft_packed_notes) / sizeof(minecraft_packed_notes[0]), minecraft_packed_notes };
+static const packed_song * const playlist[] = { &fur_elise_packed, &minecraft_packed };
+#define PLAYLIST_LEN 2
+
+// Simulated peripherals (referenced by PWM.h, TIMER.h and SEQUENCER.h in the host build)
+TIM16_TypeDef sim_TIM16;
+TIM15_TypeDef sim_TIM15;
+uint32_t sim_NVIC_ISER0;
+
+void TIM1_BRK_TIM15_IRQHandler(void);
+
+typedef enum { RUN_IDLE, RUN_COOPERATIVE, RUN_BLOCKING } run_mode;
+
+// One web request: when its last byte arrived and how long the conversion wait is
+typedef struct
+{
+  uint64_t arrival;
+  uint32_t wait_ms;
+} request;
+
+static request requests[MAX_REQUESTS];
+static int request_count = 0;
+
+// Latency statistics in cycles
+typedef struct
+{
+  uint64_t worst;
+  uint64_t total;
+  uint32_t count;
+} stats;
+
+static void add(stats * s, uint64_t cycles) {
+    if (cycles > s->worst) s->worst = cycles;
+    s->total += cycles;
+    s->count++;
+}
+
+static double ms_of(uint64_t cycles) {
+    return (double)cycles / MS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// CPU and TIM15 model
+///////////////////////////////////////////////////////////////////////////////
+
+static uint64_t now;
+static uint64_t note_end;         // next TIM15 overflow, NEVER while the interrupt is off
+static uint64_t isr_cycles;
+static int next_song;
+static uint64_t song_start[PLAYLIST_LEN], song_stop[PLAYLIST_LEN];
+static uint32_t dropped_before;   // player_dropped() when the run started
+
+// Interrupt-to-callback latency: post time of every queued event, in queue order
+static uint64_t posted[PLAYER_QUEUE_LEN];
+static uint32_t posted_head, posted_tail;
+static uint32_t deepest;
+static stats events;
+
+static uint64_t tim15_period(void) {
+    return (uint64_t)(TIM15->PSC + 1) * (TIM15->ARR + 1);
+}
+
+// Picks up what the firmware wrote: a UG restarts the count, UIE decides whether notes keep coming
+static void sync_tim15(void) {
+    if (TIM15->EGR & 1) {
+        TIM15->EGR = 0;
+        note_end = now + tim15_period();
+    }
+    if (!(TIM15->DIER & 1)) note_end = NEVER;
+}
+
+// The TIM15 update interrupt at time t (ARR preload is off: the new period starts at t)
+static void interrupt(uint64_t t) {
+    uint32_t dropped = player_dropped();
+    TIM15->SR |= 1;
+    TIM1_BRK_TIM15_IRQHandler();
+    note_end = (TIM15->DIER & 1) ? t + tim15_period() : NEVER;
+    if (note_end == NEVER) song_stop[next_song - 1] = t;
+
+    if (player_dropped() == dropped) {
+        posted[posted_head++ % PLAYER_QUEUE_LEN] = t;
+        if (posted_head - posted_tail > deepest) deepest = posted_head - posted_tail;
+    }
+}
+
+// Main-context work of the given length; interrupts preempt it and stretch it
+static void cpu_run(uint64_t cycles) {
+    uint64_t end = now + cycles;
+    while (note_end <= end) {
+        uint64_t t = note_end;
+        interrupt(t);
+        end += isr_cycles;
+    }
+    now = end;
+}
+
+// WFI: sleeps until the next interrupt (a note boundary or a request byte), then runs it
+static void sleep_until(uint64_t wake) {
+    if (note_end == NEVER && wake == NEVER) return; // nothing left to wake up for: the loop ends
+    if (note_end <= wake) {
+        now = note_end;
+        interrupt(now);
+        now += isr_cycles;
+    } else if (wake != NEVER) {
+        now = wake;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Firmware under test
+///////////////////////////////////////////////////////////////////////////////
+
+static void start_next_song(void) {
+    if (next_song >= PLAYLIST_LEN) return;
+    song_start[next_song] = now;
+    play_song_packed(playlist[next_song++]);
+    sync_tim15();
+}
+
+// Player callback (runs in player_poll()): a song is over -> the next one starts
+static void on_player_event(const player_event * event) {
+    add(&events, now - posted[posted_tail++ % PLAYER_QUEUE_LEN]);
+    cpu_run(POLL_CYCLES);
+    if (event->type == PLAYER_SONG_DONE) start_next_song();
+}
+
+// One step of the lab6 loop: serve the oldest waiting request, if any
+static int next_request;
+static stats responses;
+
+static void sensor_step(void) {
+    if (next_request >= request_count || requests[next_request].arrival > now) return;
+    request * r = &requests[next_request++];
+    cpu_run(r->wait_ms * MS);                     // writeToTempSensor(): SPI write, conversion wait
+    cpu_run(PAGE_BYTES * USART_BYTE_CYCLES);      // sendString() of the whole page
+    add(&responses, now - r->arrival);
+}
+
+static uint64_t next_wake(void) {
+    return next_request < request_count ? requests[next_request].arrival : NEVER;
+}
+
+static void run(run_mode mode) {
+    now = 0;
+    note_end = NEVER;
+    next_song = 0;
+    posted_head = posted_tail = deepest = 0;
+    dropped_before = player_dropped();
+    next_request = 0;
+    events = (stats){0};
+    responses = (stats){0};
+
+    if (mode == RUN_BLOCKING) {
+        // Old main.c: each song with play_song_packed(); while (song_playing()) wfi;
+        player_on_event(0);
+        while (next_song < PLAYLIST_LEN) {
+            start_next_song();
+            while (song_playing()) sleep_until(NEVER);
+        }
+        player_poll(); // nobody was listening: discard the queued events
+        posted_head = posted_tail = 0;
+    } else if (mode == RUN_COOPERATIVE) {
+        player_on_event(on_player_event);
+        start_next_song();
+    }
+
+    // The main loop: play_cooperatively() with the sensor loop as its other work
+    while (player_poll() || next_request < request_count) {
+        sensor_step();
+        // player_wait(): sleep only when nothing is queued and no request is waiting
+        if (posted_head != posted_tail) continue;
+        if (next_request < request_count && requests[next_request].arrival <= now) continue;
+        sleep_until(next_wake());
+    }
+}
+
+static void report(const char * name, run_mode mode) {
+    printf("%-12s requests %d: response worst %8.1f ms, mean %8.1f ms", name, responses.count,
+           ms_of(responses.worst), responses.count ? ms_of(responses.total) / responses.count : 0);
+    if (mode != RUN_IDLE) {
+        printf(" | songs");
+        for (int i = 0; i < PLAYLIST_LEN; i++) {
+            printf(" %.3f-%.3f s", (double)song_start[i] / CORE_HZ, (double)song_stop[i] / CORE_HZ);
+        }
+    }
+    printf("\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char ** argv) {
+    double mean_ms = argc > 1 ? atof(argv[1]) : 2000;
+    isr_cycles = argc > 2 ? (uint64_t)atoi(argv[2]) : 400;
+    srand(argc > 3 ? atoi(argv[3]) : 1);
+
+    init_PWM();
+    init_delaying();
+    sim_TIM15.EGR = 0;
+
+    // Song lengths first (no other work), then random requests over them
+    run(RUN_COOPERATIVE);
+    uint64_t alone[PLAYLIST_LEN], total = song_stop[PLAYLIST_LEN - 1];
+    for (int i = 0; i < PLAYLIST_LEN; i++) alone[i] = song_stop[i] - song_start[i];
+
+    // The resolution buttons (8..12 bit) wait for one conversion; the LED buttons do not
+    static const uint32_t waits[7] = { 75, 150, 300, 600, 900, 0, 0 };
+    uint64_t t = 0;
+    while (request_count < MAX_REQUESTS) {
+        t += (uint64_t)(-log(1.0 - (rand() + 0.5) / ((double)RAND_MAX + 1)) * mean_ms * MS);
+        if (t >= total) break;
+        requests[request_count].arrival = t;
+        requests[request_count].wait_ms = waits[rand() % 7];
+        request_count++;
+    }
+
+    printf("%d requests over %.3f s of songs (mean gap %.0f ms), TIM15 interrupt %llu cycles\n",
+           request_count, (double)total / CORE_HZ, mean_ms, (unsigned long long)isr_cycles);
+
+    run(RUN_IDLE);
+    report("idle", RUN_IDLE);
+    stats idle = responses;
+
+    run(RUN_BLOCKING);
+    report("blocking", RUN_BLOCKING);
+
+    run(RUN_COOPERATIVE);
+    report("cooperative", RUN_COOPERATIVE);
+    uint32_t lost = player_dropped() - dropped_before;
+    printf("player events %u: delivery worst %.1f ms, mean %.2f ms, deepest queue %u of %d, dropped %u\n",
+           events.count, ms_of(events.worst), events.count ? ms_of(events.total) / events.count : 0,
+           deepest, PLAYER_QUEUE_LEN, (unsigned)lost);
+
+    int on_time = 1;
+    for (int i = 0; i < PLAYLIST_LEN; i++) if (song_stop[i] - song_start[i] != alone[i]) on_time = 0;
+    int ok = on_time && lost == 0 && responses.worst <= idle.worst + idle.worst / 100;
+    printf("%s: song lengths unchanged, no events lost, cooperative response within 1%% of idle\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+// Filename: DDS_BENCH.c
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+
+// Host benchmark of the DDS mixer. Links the real DDS.c, ENVELOPE.c and POLY_SONG.c against simulated
+// TIM6/TIM16 registers and reports:
+//    -- the cost of DDS_mix() with all DDS_VOICES voices sounding, in ns and (on x86) TSC cycles per
+//       sample, best of several runs, next to the 80 MHz budget per sample at the sample rate
+//    -- clipping of the CHORD_DEMO song (SONGS.h): play_poly_song() runs unchanged, with delaying()
+//       replaced by calls to the real sample interrupt, and every CCR1 it writes is checked against the
+//       rails of the saturated mix. With DDS_MIX_SHIFT scaled to the voice count, no sample may clip.
+// Host time is not M4 time: on the board, DDS_max_cycles() gives the interrupt's cycles.
+//
+// Build and run from lab4/fpga/src:
+//    gcc -O2 -I. -o dds_bench host/DDS_BENCH.c DDS.c ENVELOPE.c POLY_SONG.c PWM.c PITCHES.c
+//    ./dds_bench
+//
+// Usage: dds_bench [samples] [runs] [sample_rate]
+//    -- samples: DDS_mix() calls per timed run, 1000000 by default
+//    -- runs: timed runs (the best one is reported), 10 by default
+//    -- sample_rate: init_DDS() argument, 16000 (as in main.c) by default
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "DDS.h"
+#include "POLY_SONG.h"
+#include "SONGS.h"
+#include "STM32L432KC_RCC.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define CORE_HZ 80000000
+
+// Simulated peripherals (referenced by DDS.h, PWM.h and STM32L432KC_RCC.h in the host build)
+TIM6_TypeDef sim_TIM6;
+TIM16_TypeDef sim_TIM16;
+RCC_TypeDef sim_RCC;
+uint32_t sim_NVIC_ISER1, sim_DEMCR, sim_DWT_CTRL, sim_DWT_CYCCNT;
+
+void TIM6_DAC_IRQHandler(void);
+
+const poly_step chord_demo[] = { CHORD_DEMO(POLY_STEP) };
+const instrument chord_demo_voices[DDS_VOICES] = CHORD_DEMO_VOICES;
+
+static volatile uint32_t sink; // keeps the compiler from dropping the mix
+static uint32_t rate;
+
+// Chord demo output: duties written, and how many sat on a rail of the saturated mix
+static uint64_t duties = 0, clipped = 0;
+static uint32_t lowest = DDS_ARR, highest = 0;
+
+// Rails: CCR1 of a mix saturated at +32767 and -32767 (DDS_mix()'s mapping)
+#define DUTY_OF(sum) ((uint32_t)((DDS_ARR + 1) / 2 + (((int32_t)(sum) * ((DDS_ARR + 1) / 2)) >> 15)))
+#define DUTY_TOP DUTY_OF(32767)
+#define DUTY_BOTTOM DUTY_OF(-32767)
+
+///////////////////////////////////////////////////////////////////////////////
+// delaying() for POLY_SONG.c: runs the sample interrupt for the duration
+///////////////////////////////////////////////////////////////////////////////
+
+void delaying(int ms) {
+    uint64_t n = (uint64_t)ms * rate / 1000;
+    for (uint64_t i = 0; i < n; i++) {
+        TIM6_DAC_IRQHandler();
+        uint32_t duty = TIM16->CCR1;
+        duties++;
+        if (duty >= DUTY_TOP || duty <= DUTY_BOTTOM) clipped++;
+        if (duty < lowest) lowest = duty;
+        if (duty > highest) highest = duty;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Benchmark
+///////////////////////////////////////////////////////////////////////////////
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static uint64_t now_tsc(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+int main(int argc, char ** argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 1000000;
+    int runs = argc > 2 ? atoi(argv[2]) : 10;
+    rate = argc > 3 ? (uint32_t)atoi(argv[3]) : 16000;
+
+    // All voices sounding (organ: full level at once), applied by one sample interrupt
+    init_DDS(rate);
+    DDS_waveform(DDS_SINE);
+    const int chord[DDS_VOICES] = {262, 330, 392, 523};
+    for (int v = 0; v < DDS_VOICES; v++) DDS_voice(v, chord[v]);
+    TIM6_DAC_IRQHandler();
+
+    uint64_t best_ns = UINT64_MAX, best_tsc = UINT64_MAX;
+    for (int r = 0; r < runs; r++) {
+        uint64_t t0 = now_ns(), c0 = now_tsc();
+        for (int i = 0; i < n; i++) sink = DDS_mix();
+        uint64_t c1 = now_tsc(), t1 = now_ns();
+        if (t1 - t0 < best_ns) best_ns = t1 - t0;
+        if (c1 - c0 < best_tsc) best_tsc = c1 - c0;
+    }
+    printf("DDS_mix(), %d voices, %d samples, best of %d runs: %.2f ns", DDS_VOICES, n, runs, (double)best_ns / n);
+    if (best_tsc) printf(", %.1f TSC cycles", (double)best_tsc / n);
+    printf(" per sample (budget at %u Hz: %u cycles at 80 MHz)\n", rate, CORE_HZ / rate);
+
+    // Chord demo through the real song player and sample interrupt
+    init_DDS(rate);
+    play_poly_song(chord_demo, sizeof(chord_demo) / sizeof(chord_demo[0]), chord_demo_voices);
+    printf("CHORD_DEMO, DDS_MIX_SHIFT %d: %llu samples, duty %u..%u of rails %u..%u, %llu clipped %s\n",
+           DDS_MIX_SHIFT, (unsigned long long)duties, lowest, highest, DUTY_BOTTOM, DUTY_TOP,
+           (unsigned long long)clipped, clipped ? "FAIL" : "ok");
+    return clipped ? 1 : 0;
+}
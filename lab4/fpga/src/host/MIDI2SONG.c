@@ -0,0 +1,562 @@
+// Filename: MIDI2SONG.c
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+
+// Host-side song compiler: reads a Standard MIDI File (format 0 or 1), quantizes every note to the
+// player's timing grid (the song's tempo base in ms), reduces the selected tracks to one melody
+// line and prints a song table for main.c in one of three layouts:
+//    -- list: a SONGS.h note list, N(name, ms) per note plus NAME_TEMPO, that main.c can expand into
+//             {Hz, ms} pairs, NOTE_REGS and packed notes like the hand-written songs
+//    -- hz:   const int name[][2] = { {Hz, ms}, ... } (play_song())
+//    -- regs: const note_regs name[] with the TIM16 PSC/ARR/CCR1 and TIM15 reload values already
+//             computed by the firmware's own PWM_PSC_OPT/PWM_ARR_OPT/DELAY_TICKS macros (play_song_regs())
+// Every table ends with a 0 ms note, the end marker the sequencer stops at.
+//
+// Timing: note on/off times go through the file's tempo map (or the -t override) to microseconds
+// and are rounded to the grid as absolute times, so rounding never accumulates over the song.
+// A note shorter than half a grid step still gets one step. Notes longer than a table entry can hold
+// (255 tempo units in a list, 2457 ms of TIM15 reload in regs) are split into repeated entries.
+// Notes outside C2..C8 (PITCHES.h) are moved by octaves into that range.
+//
+// Build and run from lab4/fpga/src:
+//    gcc -O2 -I. -o midi2song host/MIDI2SONG.c PITCHES.c
+//    ./midi2song -l song.mid                       (list the tracks)
+//    ./midi2song -f list -n waltz -g 125 -k 1 song.mid > waltz.h
+//
+// Usage: midi2song [options] <file.mid>
+//    -f list|hz|regs   output layout (list)
+//    -n name           table name (song); list macros use it in capitals
+//    -g ms             timing grid in ms (25)
+//    -k tracks         comma-separated track numbers to use (all)
+//    -m highest|lowest|last
+//                      which of several sounding notes the melody keeps (highest): the top
+//                      voice, the bass line, or the note that started last
+//    -t bpm            tempo override: ignore the file's tempo changes
+//    -d                keep MIDI channel 10 (drums), skipped by default
+//    -l                list the tracks and exit
+//    -o file           write the table to a file instead of stdout
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "PITCHES.h"
+#include "PWM.h"
+#include "TIMER.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define MAX_TRACKS 64
+#define LOWEST_NOTE 36             // C2, the first PITCHES.h name
+#define HIGHEST_NOTE 108           // C8
+#define MAX_LIST_UNITS 0xFF        // packed duration limit (PACKED_SONG.h)
+#define MAX_REGS_MS 2457           // DELAY_TICKS(ms) must fit the 16-bit TIM15 reload (TIMER.h)
+#define NO_NOTE -1
+
+typedef enum { OUT_LIST, OUT_HZ, OUT_REGS } out_format;
+typedef enum { KEEP_HIGHEST, KEEP_LOWEST, KEEP_LAST } mono_rule;
+
+// A note on or off as read from a track
+typedef struct
+{
+  uint64_t tick;
+  uint32_t order;   // position in the file, keeps simultaneous events in file order
+  uint8_t on;
+  uint8_t channel;
+  uint8_t note;
+} midi_event;
+
+typedef struct
+{
+  uint64_t tick;
+  uint32_t us_per_quarter;
+} tempo_change;
+
+// A note with its quantized start and end (grid steps)
+typedef struct
+{
+  int64_t start;
+  int64_t end;
+  uint8_t note;
+} grid_note;
+
+// One table entry: a note (0 = rest) held for some grid steps
+typedef struct
+{
+  uint8_t note;
+  int64_t steps;
+} segment;
+
+typedef struct
+{
+  char name[64];
+  int notes;
+  uint16_t channels; // bit per MIDI channel used
+} track_info;
+
+// Growable arrays
+static midi_event * events;
+static size_t event_count = 0, event_cap = 0;
+static tempo_change * tempos;
+static size_t tempo_count = 0, tempo_cap = 0;
+static track_info tracks[MAX_TRACKS];
+static int track_count = 0;
+
+static void fail(const char * message) {
+    fprintf(stderr, "midi2song: %s\n", message);
+    exit(1);
+}
+
+static void * grow(void * array, size_t * cap, size_t count, size_t size) {
+    if (count < *cap) return array;
+    *cap = *cap ? *cap * 2 : 1024;
+    array = realloc(array, *cap * size);
+    if (!array) fail("out of memory");
+    return array;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Standard MIDI File reader
+///////////////////////////////////////////////////////////////////////////////
+
+static const uint8_t * data;
+static size_t data_size;
+
+static uint32_t read_be(size_t pos, int bytes) {
+    if (pos + bytes > data_size) fail("file is truncated");
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; i++) value = (value << 8) | data[pos + i];
+    return value;
+}
+
+// Variable-length quantity: 7 bits per byte, high bit set on all but the last
+static uint32_t read_vlq(size_t * pos, size_t end) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        if (*pos >= end) fail("track is truncated");
+        uint8_t byte = data[(*pos)++];
+        value = (value << 7) | (byte & 0x7F);
+        if (!(byte & 0x80)) return value;
+    }
+    fail("bad variable-length number");
+    return 0;
+}
+
+// Reads one MTrk chunk. Tempo changes are kept from every track; note events only from used ones.
+static void read_track(size_t pos, size_t end, int track, const uint8_t * used, int drums) {
+    uint64_t tick = 0;
+    uint8_t running = 0;
+    track_info * info = &tracks[track];
+
+    while (pos < end) {
+        tick += read_vlq(&pos, end);
+        if (pos >= end) fail("track is truncated");
+        uint8_t status = data[pos];
+
+        if (status == 0xFF) {                       // meta event
+            if (pos + 2 > end) fail("track is truncated");
+            uint8_t type = data[pos + 1];
+            pos += 2;
+            uint32_t length = read_vlq(&pos, end);
+            if (pos + length > end) fail("track is truncated");
+            if (type == 0x51 && length == 3) {      // set tempo
+                tempos = grow(tempos, &tempo_cap, tempo_count, sizeof(tempo_change));
+                tempos[tempo_count++] = (tempo_change){ tick, read_be(pos, 3) };
+            } else if (type == 0x03 && !info->name[0]) { // track name
+                size_t n = length < sizeof(info->name) - 1 ? length : sizeof(info->name) - 1;
+                memcpy(info->name, &data[pos], n);
+                info->name[n] = 0;
+            } else if (type == 0x2F) {              // end of track
+                return;
+            }
+            pos += length;
+            continue;
+        }
+
+        if (status == 0xF0 || status == 0xF7) {     // SysEx
+            pos++;
+            uint32_t length = read_vlq(&pos, end);
+            pos += length;
+            continue;
+        }
+
+        // Channel message, with or without its status byte (running status). Meta and SysEx events
+        // should cancel running status; some writers rely on it anyway, so it is kept across them.
+        if (status & 0x80) {
+            running = status;
+            pos++;
+        } else if (!running) {
+            fail("data byte without a status byte");
+        }
+        uint8_t kind = running & 0xF0, channel = running & 0x0F;
+        int length = (kind == 0xC0 || kind == 0xD0) ? 1 : 2;
+        if (pos + length > end) fail("track is truncated");
+        uint8_t note = data[pos], velocity = (length == 2) ? data[pos + 1] : 0;
+        pos += length;
+
+        if (kind != 0x90 && kind != 0x80) continue;
+        int on = (kind == 0x90 && velocity != 0);
+        if (on) {
+            info->notes++;
+            info->channels |= 1 << channel;
+        }
+        if (!used[track] || (channel == 9 && !drums)) continue;
+
+        events = grow(events, &event_cap, event_count, sizeof(midi_event));
+        events[event_count] = (midi_event){ tick, (uint32_t)event_count, (uint8_t)on, channel, note & 0x7F };
+        event_count++;
+    }
+}
+
+// Returns the division (ticks per quarter note, or SMPTE frames and ticks per frame)
+static uint16_t read_file(const uint8_t * used, int drums) {
+    if (data_size < 14 || memcmp(data, "MThd", 4) != 0) fail("not a Standard MIDI File");
+    uint32_t header = read_be(4, 4);
+    uint16_t format = read_be(8, 2), count = read_be(10, 2), division = read_be(12, 2);
+    if (format > 1) fail("format 2 (independent sequences) is not supported");
+    if (division == 0) fail("division is 0");
+
+    size_t pos = 8 + header;
+    while (pos + 8 <= data_size && track_count < count && track_count < MAX_TRACKS) {
+        uint32_t length = read_be(pos + 4, 4);
+        size_t end = pos + 8 + length;
+        if (end > data_size) fail("chunk is truncated");
+        if (memcmp(&data[pos], "MTrk", 4) == 0) read_track(pos + 8, end, track_count++, used, drums);
+        pos = end;                                  // other chunk types are skipped
+    }
+    return division;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Timing and melody
+///////////////////////////////////////////////////////////////////////////////
+
+// Same tick: offs first, so a note struck again at the moment it ends starts a new note
+static int event_order(const void * a, const void * b) {
+    const midi_event * x = a, * y = b;
+    if (x->tick != y->tick) return x->tick < y->tick ? -1 : 1;
+    if (x->on != y->on) return x->on - y->on;
+    return x->order < y->order ? -1 : 1;
+}
+
+static int tempo_order(const void * a, const void * b) {
+    const tempo_change * x = a, * y = b;
+    return (x->tick > y->tick) - (x->tick < y->tick);
+}
+
+// Converts the sorted events to grid notes. Returns the number of notes.
+static size_t quantize(grid_note * notes, uint16_t division, uint32_t us_override, uint32_t grid_ms,
+                       uint64_t * end_us) {
+    qsort(tempos, tempo_count, sizeof(tempo_change), tempo_order);
+
+    // Open notes per channel and key, oldest first (a key struck twice before its off)
+    static int64_t open_start[16][128][4];
+    static uint8_t open_count[16][128];
+    memset(open_count, 0, sizeof(open_count));
+
+    size_t count = 0, t = 0;
+    uint32_t us_per_quarter = us_override ? us_override : 500000; // SMF default: 120 bpm
+    uint64_t tempo_tick = 0;
+    double tempo_us = 0;
+    double grid_us = grid_ms * 1000.0;
+    double us = 0;
+
+    for (size_t i = 0; i < event_count; i++) {
+        midi_event * e = &events[i];
+
+        // Microseconds at this tick through the tempo map
+        if (division & 0x8000) {
+            int fps = -(int8_t)(division >> 8);
+            us = e->tick * 1e6 / ((double)fps * (division & 0xFF));
+        } else {
+            for (; t < tempo_count && tempos[t].tick <= e->tick; t++) {
+                tempo_us += (double)(tempos[t].tick - tempo_tick) * us_per_quarter / division;
+                tempo_tick = tempos[t].tick;
+                if (!us_override) us_per_quarter = tempos[t].us_per_quarter;
+            }
+            us = tempo_us + (double)(e->tick - tempo_tick) * us_per_quarter / division;
+        }
+        int64_t step = (int64_t)(us / grid_us + 0.5);
+
+        uint8_t * open = &open_count[e->channel][e->note];
+        if (e->on) {
+            if (*open < 4) open_start[e->channel][e->note][(*open)++] = step;
+        } else if (*open) {
+            int64_t start = open_start[e->channel][e->note][0];
+            memmove(&open_start[e->channel][e->note][0], &open_start[e->channel][e->note][1], --*open * sizeof(int64_t));
+            notes[count++] = (grid_note){ start, step > start ? step : start + 1, e->note };
+        }
+    }
+
+    // Notes never switched off end with the last event
+    int64_t last = (int64_t)(us / grid_us + 0.5);
+    for (int c = 0; c < 16; c++) {
+        for (int k = 0; k < 128; k++) {
+            for (int n = 0; n < open_count[c][k]; n++) {
+                int64_t start = open_start[c][k][n];
+                notes[count++] = (grid_note){ start, last > start ? last : start + 1, (uint8_t)k };
+            }
+        }
+    }
+    *end_us = (uint64_t)us;
+    return count;
+}
+
+static int start_order(const void * a, const void * b) {
+    const grid_note * x = a, * y = b;
+    if (x->start != y->start) return x->start < y->start ? -1 : 1;
+    return (int)x->note - (int)y->note;
+}
+
+// Which sounding note the melody keeps
+static int keep(const grid_note * notes, const int * active, int active_count, mono_rule rule) {
+    int best = NO_NOTE;
+    for (int i = 0; i < active_count; i++) {
+        const grid_note * n = &notes[active[i]];
+        if (best == NO_NOTE) { best = active[i]; continue; }
+        const grid_note * b = &notes[best];
+        if ((rule == KEEP_HIGHEST && n->note > b->note) ||
+            (rule == KEEP_LOWEST && n->note < b->note) ||
+            (rule == KEEP_LAST && (n->start > b->start || (n->start == b->start && n->note > b->note)))) {
+            best = active[i];
+        }
+    }
+    return best;
+}
+
+static void add_segment(segment * out, size_t * count, uint8_t note, int64_t steps) {
+    if (steps <= 0) return;
+    if (*count > 0 && note == 0 && out[*count - 1].note == 0) out[*count - 1].steps += steps; // rest after rest
+    else out[(*count)++] = (segment){ note, steps };
+}
+
+// Sweeps the grid notes into one line. A new note (even at the same pitch) starts a new segment.
+static size_t melody(grid_note * notes, size_t count, mono_rule rule, segment * out, size_t * dropped) {
+    qsort(notes, count, sizeof(grid_note), start_order);
+
+    int * active = malloc((count + 1) * sizeof(int));
+    uint8_t * heard = calloc(count + 1, 1);
+    if (!active || !heard) fail("out of memory");
+    int active_count = 0;
+    size_t next = 0, segments = 0;
+    int current = NO_NOTE;
+    int64_t now = count ? notes[0].start : 0, segment_start = now;
+
+    while (next < count || active_count > 0) {
+        // Next boundary: the earliest end among sounding notes or the next start
+        int64_t t = INT64_MAX;
+        for (int i = 0; i < active_count; i++) if (notes[active[i]].end < t) t = notes[active[i]].end;
+        if (next < count && notes[next].start < t) t = notes[next].start;
+        now = t;
+
+        for (int i = 0; i < active_count; ) {
+            if (notes[active[i]].end <= now) active[i] = active[--active_count];
+            else i++;
+        }
+        while (next < count && notes[next].start == now) active[active_count++] = (int)next++;
+
+        int pick = keep(notes, active, active_count, rule);
+        if (pick != current) {
+            add_segment(out, &segments, current == NO_NOTE ? 0 : notes[current].note, now - segment_start);
+            segment_start = now;
+            current = pick;
+            if (pick != NO_NOTE) heard[pick] = 1;
+        }
+    }
+
+    *dropped = 0;
+    for (size_t i = 0; i < count; i++) if (!heard[i]) (*dropped)++;
+    free(active);
+    free(heard);
+    return segments;
+}
+
+// Moves a note by octaves into the PITCHES.h names
+static uint8_t fold(uint8_t note, size_t * folded) {
+    if (note == 0) return 0;
+    if (note < LOWEST_NOTE || note > HIGHEST_NOTE) (*folded)++;
+    while (note < LOWEST_NOTE) note += 12;
+    while (note > HIGHEST_NOTE) note -= 12;
+    return note;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Output
+///////////////////////////////////////////////////////////////////////////////
+
+static void note_name(uint8_t note, char * name) {
+    static const char * const names[12] = { "C", "CS", "D", "DS", "E", "F", "FS", "G", "GS", "A", "AS", "B" };
+    if (note == 0) strcpy(name, "REST");
+    else sprintf(name, "%s%d", names[note % 12], note / 12 - 1);
+}
+
+static void print_entry(FILE * f, out_format format, uint8_t note, uint32_t ms) {
+    char name[8], entry[32];
+    uint32_t hz = pitch_hz(note);
+
+    switch (format) {
+    case OUT_LIST:
+        note_name(note, name);
+        snprintf(entry, sizeof(entry), "N(%s, %u)", name, ms);
+        fprintf(f, "    %-14s\\\n", entry);
+        break;
+    case OUT_HZ:
+        fprintf(f, "    {%u, %u},\n", hz, ms);
+        break;
+    case OUT_REGS:
+        // Same values as NOTE_REGS(hz, ms) in SEQUENCER.h
+        fprintf(f, "    {%u, %u, %u, %u},\n", (unsigned)PWM_PSC_OPT(hz), (unsigned)PWM_ARR_OPT(hz),
+                (unsigned)(PWM_ARR_OPT(hz) / 2), ms == 0 ? 0u : (unsigned)(DELAY_TICKS(ms) - 1));
+        break;
+    }
+}
+
+static void print_table(FILE * f, out_format format, const char * name, const char * source,
+                        const segment * line, size_t count, uint32_t grid_ms) {
+    char upper[64];
+    size_t n = 0;
+    for (; name[n] && n < sizeof(upper) - 1; n++) upper[n] = (char)toupper((unsigned char)name[n]);
+    upper[n] = 0;
+
+    // Longest entry the layout can hold, in grid steps
+    int64_t max_steps = (format == OUT_LIST) ? MAX_LIST_UNITS : (format == OUT_REGS) ? MAX_REGS_MS / grid_ms : INT32_MAX / grid_ms;
+
+    fprintf(f, "// %s: generated by host/MIDI2SONG.c from %s\n", name, source);
+    switch (format) {
+    case OUT_LIST:
+        fprintf(f, "#define %s_TEMPO %u // ms per packed time unit\n", upper, grid_ms);
+        fprintf(f, "#define %s_SONG(N) \\\n", upper);
+        break;
+    case OUT_HZ:
+        fprintf(f, "const int %s[][2] = {\n", name);
+        break;
+    case OUT_REGS:
+        fprintf(f, "const note_regs %s[] = {\n", name);
+        break;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        for (int64_t left = line[i].steps; left > 0; left -= max_steps) {
+            int64_t steps = left < max_steps ? left : max_steps;
+            print_entry(f, format, line[i].note, (uint32_t)(steps * grid_ms));
+        }
+    }
+
+    if (format == OUT_LIST) fprintf(f, "    N(REST, 0)\n");
+    else {
+        print_entry(f, format, 0, 0);
+        fprintf(f, "};\n");
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+///////////////////////////////////////////////////////////////////////////////
+
+static void usage(const char * program) {
+    fprintf(stderr, "usage: %s [-f list|hz|regs] [-n name] [-g grid_ms] [-k tracks] [-m highest|lowest|last] "
+                    "[-t bpm] [-d] [-l] [-o out] <file.mid>\n", program);
+    exit(2);
+}
+
+int main(int argc, char ** argv) {
+    out_format format = OUT_LIST;
+    mono_rule rule = KEEP_HIGHEST;
+    const char * name = "song", * out_path = 0, * track_list = 0;
+    uint32_t grid_ms = 25, us_override = 0;
+    int drums = 0, list_only = 0, option;
+
+    while ((option = getopt(argc, argv, "f:n:g:k:m:t:dlo:")) != -1) {
+        switch (option) {
+        case 'f':
+            if (strcmp(optarg, "list") == 0) format = OUT_LIST;
+            else if (strcmp(optarg, "hz") == 0) format = OUT_HZ;
+            else if (strcmp(optarg, "regs") == 0) format = OUT_REGS;
+            else usage(argv[0]);
+            break;
+        case 'n': name = optarg; break;
+        case 'g': grid_ms = (uint32_t)atoi(optarg); break;
+        case 'k': track_list = optarg; break;
+        case 'm':
+            if (strcmp(optarg, "highest") == 0) rule = KEEP_HIGHEST;
+            else if (strcmp(optarg, "lowest") == 0) rule = KEEP_LOWEST;
+            else if (strcmp(optarg, "last") == 0) rule = KEEP_LAST;
+            else usage(argv[0]);
+            break;
+        case 't':
+            if (atof(optarg) <= 0) usage(argv[0]);
+            us_override = (uint32_t)(60e6 / atof(optarg) + 0.5);
+            break;
+        case 'd': drums = 1; break;
+        case 'l': list_only = 1; break;
+        case 'o': out_path = optarg; break;
+        default: usage(argv[0]);
+        }
+    }
+    if (optind != argc - 1 || grid_ms == 0 || grid_ms > MAX_REGS_MS) usage(argv[0]);
+
+    uint8_t used[MAX_TRACKS];
+    memset(used, track_list ? 0 : 1, sizeof(used));
+    for (const char * p = track_list; p && *p; ) {
+        int k = atoi(p);
+        if (k >= 0 && k < MAX_TRACKS) used[k] = 1;
+        p = strchr(p, ',');
+        if (p) p++;
+    }
+
+    FILE * in = fopen(argv[optind], "rb");
+    if (!in) fail("cannot open the MIDI file");
+    fseek(in, 0, SEEK_END);
+    data_size = (size_t)ftell(in);
+    fseek(in, 0, SEEK_SET);
+    uint8_t * file = malloc(data_size ? data_size : 1);
+    if (!file || fread(file, 1, data_size, in) != data_size) fail("cannot read the MIDI file");
+    fclose(in);
+    data = file;
+
+    clock_t started = clock();
+    uint16_t division = read_file(used, drums);
+
+    if (list_only) {
+        for (int k = 0; k < track_count; k++) {
+            printf("track %2d: %5d notes, channels", k, tracks[k].notes);
+            for (int c = 0; c < 16; c++) if (tracks[k].channels & (1 << c)) printf(" %d", c + 1);
+            printf("%s  %s\n", tracks[k].channels ? "" : " -", tracks[k].name);
+        }
+        return 0;
+    }
+    if (event_count == 0) fail("no notes in the selected tracks");
+
+    qsort(events, event_count, sizeof(midi_event), event_order);
+    grid_note * notes = malloc(event_count * sizeof(grid_note));
+    segment * line = malloc((2 * event_count + 1) * sizeof(segment));
+    if (!notes || !line) fail("out of memory");
+
+    uint64_t end_us;
+    size_t note_count = quantize(notes, division, us_override, grid_ms, &end_us);
+    size_t dropped, folded = 0;
+    size_t segments = melody(notes, note_count, rule, line, &dropped);
+    for (size_t i = 0; i < segments; i++) line[i].note = fold(line[i].note, &folded);
+    double elapsed_ms = (double)(clock() - started) * 1000.0 / CLOCKS_PER_SEC;
+
+    FILE * out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out) fail("cannot open the output file");
+    print_table(out, format, name, argv[optind], line, segments, grid_ms);
+    if (out_path) fclose(out);
+
+    int64_t steps = 0;
+    for (size_t i = 0; i < segments; i++) steps += line[i].steps;
+    fprintf(stderr, "%s: %zu notes -> %zu entries (%zu hidden under the melody, %zu moved by octaves), "
+                    "%.1f s at a %u ms grid (file: %.1f s), converted in %.2f ms\n",
+            name, note_count, segments, dropped, folded, steps * grid_ms / 1000.0, grid_ms,
+            end_us / 1e6, elapsed_ms);
+    free(file);
+    free(notes);
+    free(line);
+    return 0;
+}
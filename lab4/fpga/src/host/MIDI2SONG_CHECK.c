@@ -0,0 +1,80 @@
+// Filename: MIDI2SONG_CHECK.c
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+
+// Host check of the MIDI2SONG.c tables. check.sh writes a small format 0 MIDI file (96 ticks per
+// quarter) and converts it in every layout; this file includes the generated tables next to SONGS.h
+// and SEQUENCER.h, so they must compile as main.c would use them, and compares them entry by entry
+// (the list also as packed notes).
+// The file, in ms:
+//    0     tempo 120 bpm, C4 on
+//    250   E4 on (running status), over C4
+//    500   C4 off (running status, velocity 0), tempo 60 bpm
+//    1000  E4 off
+//    1500  G4 on
+//    1750  A4 on (running status), over G4
+//    2000  G4 off
+//    4750  A4 off (two-byte delta)
+// The highest-note melody is C4 250, E4 750, a 500 ms rest, G4 250, A4 3000; regs split the A4, past
+// the 2457 ms TIM15 reload, into 2450 + 550 ms. The lowest-note melody keeps each note until it ends.
+//
+// Build and run from lab4/fpga/src, with the fixture_*.h tables in $out (see check.sh):
+//    gcc -O2 -I. -I"$out" -o midi2song_check host/MIDI2SONG_CHECK.c
+//    ./midi2song_check
+
+#include <stdio.h>
+#include <string.h>
+
+#include "PITCHES.h"
+#include "PACKED_SONG.h"
+#include "SEQUENCER.h"
+#include "SONGS.h"
+#include "fixture_list.h"   // midi2song -f list -n fixture
+#include "fixture_hz.h"     // midi2song -f hz -n fixture_hz
+#include "fixture_regs.h"   // midi2song -f regs -n fixture_regs
+#include "fixture_lowest.h" // midi2song -f hz -m lowest -n fixture_lowest
+
+///////////////////////////////////////////////////////////////////////////////
+// Expected tables
+///////////////////////////////////////////////////////////////////////////////
+
+#define HIGHEST(N) N(C4, 250) N(E4, 750) N(REST, 500) N(G4, 250) N(A4, 3000) N(REST, 0)
+#define HIGHEST_REGS(N) N(C4, 250) N(E4, 750) N(REST, 500) N(G4, 250) N(A4, 2450) N(A4, 550) N(REST, 0)
+#define LOWEST(N) N(C4, 500) N(E4, 500) N(REST, 500) N(G4, 500) N(A4, 2750) N(REST, 0)
+
+#define NOTE_HZ_MS(name, ms) {PITCH_HZ(name), ms},
+#define NOTE_REGS_OF(name, ms) NOTE_REGS(PITCH_HZ(name), ms)
+
+static const int highest[][2] = { HIGHEST(NOTE_HZ_MS) };
+static const note_regs highest_regs[] = { HIGHEST_REGS(NOTE_REGS_OF) };
+static const int lowest[][2] = { LOWEST(NOTE_HZ_MS) };
+
+// The list layout expanded the way main.c expands FUR_ELISE_SONG(), as {Hz, ms} and packed notes
+#define FIXTURE_PACKED(name, ms) NOTE_PACKED(name, ms, FIXTURE_TEMPO)
+#define HIGHEST_PACKED(name, ms) NOTE_PACKED(name, ms, 25)
+static const int fixture_list[][2] = { FIXTURE_SONG(NOTE_HZ_MS) };
+static const uint16_t fixture_packed[] = { FIXTURE_SONG(FIXTURE_PACKED) };
+static const uint16_t highest_packed[] = { HIGHEST(HIGHEST_PACKED) };
+
+///////////////////////////////////////////////////////////////////////////////
+// Checks
+///////////////////////////////////////////////////////////////////////////////
+
+static int check(int ok, const char * what) {
+    printf("%-40s %s\n", what, ok ? "ok" : "FAIL");
+    return !ok;
+}
+
+#define SAME(a, b) (sizeof(a) == sizeof(b) && memcmp(a, b, sizeof(a)) == 0)
+
+int main(void) {
+    int fails = 0;
+    fails += check(FIXTURE_TEMPO == 25, "list: tempo unit is the 25 ms grid");
+    fails += check(SAME(fixture_list, highest), "list: entries");
+    fails += check(SAME(fixture_packed, highest_packed), "list: packed entries");
+    fails += check(SAME(fixture_hz, highest), "hz: entries");
+    fails += check(SAME(fixture_regs, highest_regs), "regs: entries, long note split");
+    fails += check(SAME(fixture_lowest, lowest), "hz -m lowest: entries");
+    printf("%s\n", fails ? "FAIL" : "ok");
+    return fails ? 1 : 0;
+}
@@ -0,0 +1,202 @@
+// Filename: MIDI_REPLAY.c
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+
+// Host-side MIDI replay for the PLAY_MIDI synthesizer. Links the real MIDI.c, DDS.c and ENVELOPE.c
+// against simulated TIM6/TIM16 registers, plays a random MIDI byte stream at the wire rate (31250
+// baud, 25600 core cycles per byte) and measures the note-on/off-to-PWM latency in 80 MHz core cycles:
+//    from: the receive interrupt of the last byte of a message (the byte's stop bit)
+//    to:   the first TIM16 carrier period that uses the CCR1 written by the sample interrupt
+//          that applied the message
+// The stream mixes running status, velocity-0 note offs, real-time bytes and other channel
+// messages, with random idle gaps. USART2 and TIM6 share one priority, so a byte that arrives
+// while the sample interrupt runs is handled after it.
+//
+// Build and run from lab4/fpga/src:
+//    gcc -O2 -I. -o midi_replay host/MIDI_REPLAY.c MIDI.c DDS.c ENVELOPE.c PWM.c PITCHES.c
+//    ./midi_replay <isr_cycles>
+//
+// Usage: midi_replay <isr_cycles> [messages] [sample_rate] [seed]
+//    -- isr_cycles: worst-case cycles of the TIM6 interrupt handler measured on the board, i.e.
+//                   midi_isr_cycles (DDS_max_cycles()) read in the debugger after playing in PLAY_MIDI
+//                   mode; the exception entry is added here
+//    -- messages: note messages to replay, 20000 by default
+//    -- sample_rate: init_DDS() argument, 16000 (as in main.c) by default
+//    -- seed: random stream seed
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "DDS.h"
+#include "MIDI.h"
+#include "STM32L432KC_RCC.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define CORE_HZ 80000000ULL
+#define BYTE_CYCLES (CORE_HZ * 10 / MIDI_BAUD)  // start + 8 data + stop bits
+#define CARRIER_CYCLES (CORE_HZ / DDS_CARRIER_HZ)
+#define CONTROL_TICK_CYCLES (CORE_HZ / ENV_CONTROL_HZ) // the latency bound: one envelope tick
+#define ISR_ENTRY_CYCLES 12  // Cortex-M4 exception entry, not counted by DDS_max_cycles()
+#define MAX_PENDING 64
+
+// Simulated peripherals (referenced by DDS.h, PWM.h and STM32L432KC_RCC.h in the host build)
+TIM6_TypeDef sim_TIM6;
+TIM16_TypeDef sim_TIM16;
+RCC_TypeDef sim_RCC;
+uint32_t sim_NVIC_ISER1, sim_DEMCR, sim_DWT_CTRL, sim_DWT_CYCCNT;
+
+void TIM6_DAC_IRQHandler(void);
+
+// The USART2 driver needs the GPIO block; the replay calls midi_byte() itself instead
+void initUSART(int baud_rate) { (void)baud_rate; }
+void USART_on_receive(void (*handler)(uint8_t byte)) { (void)handler; }
+
+static const instrument pluck[DDS_VOICES] = { INSTRUMENT_PLUCK, INSTRUMENT_PLUCK, INSTRUMENT_PLUCK, INSTRUMENT_PLUCK };
+
+// Latency statistics in core cycles
+typedef struct
+{
+  uint64_t worst, best, total, over_bound, measured;
+} latency_stats;
+
+// Byte stream under test
+static uint8_t * stream;
+static int stream_len = 0;
+static uint8_t * completes;  // 1 where the byte completes a note on/off message
+static uint8_t running = 0;  // running status of the generator
+
+///////////////////////////////////////////////////////////////////////////////
+// Stream generator
+///////////////////////////////////////////////////////////////////////////////
+
+static void put(uint8_t byte, int complete) {
+    stream[stream_len] = byte;
+    completes[stream_len] = complete;
+    stream_len++;
+    if (rand() % 8 == 0) {           // MIDI clock between any two bytes
+        stream[stream_len] = 0xF8;
+        completes[stream_len] = 0;
+        stream_len++;
+    }
+}
+
+// One status byte, or none when running status allows it
+static void status(uint8_t byte) {
+    if (byte != running || rand() % 4 == 0) put(byte, 0);
+    running = byte;
+}
+
+static void note_message(uint8_t held[], int * held_count) {
+    uint8_t channel = rand() % 2;
+
+    if (*held_count > 0 && (rand() % 2 || *held_count >= 6)) {
+        int i = rand() % *held_count;
+        uint8_t note = held[i];
+        held[i] = held[--*held_count];
+        if (rand() % 2) { status(0x90 | channel); put(note, 0); put(0, 1); }   // note on, velocity 0
+        else            { status(0x80 | channel); put(note, 0); put(64, 1); }
+    } else {
+        uint8_t note = 48 + rand() % 37;
+        held[(*held_count)++] = note;
+        status(0x90 | channel); put(note, 0); put(1 + rand() % 127, 1);
+    }
+
+    // Now and then something the synthesizer skips
+    switch (rand() % 16) {
+        case 0: status(0xB0); put(7, 0); put(100, 0); break;              // control change
+        case 1: status(0xC0); put(rand() % 128, 0); break;                // program change (1 data byte)
+        case 2: put(0xF0, 0); put(0x7D, 0); put(0x01, 0); put(0xF7, 0); running = 0; break; // SysEx
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Replay
+///////////////////////////////////////////////////////////////////////////////
+
+// One sample interrupt at cycle `start`. Once it has applied every queued change, the messages
+// received so far become audible and are measured.
+static void sample_interrupt(uint64_t start, uint64_t isr_cycles, uint64_t pending[], int * pending_count,
+                             latency_stats * stats) {
+    TIM6_DAC_IRQHandler();
+    uint64_t ccr1_write = start + isr_cycles;
+    if (*pending_count && !DDS_pending()) {
+        // CCR1 is preloaded: it drives the pin from the next carrier period boundary
+        uint64_t audible = (ccr1_write / CARRIER_CYCLES + 1) * CARRIER_CYCLES;
+        for (int p = 0; p < *pending_count; p++) {
+            uint64_t latency = audible - pending[p];
+            if (latency > stats->worst) stats->worst = latency;
+            if (latency < stats->best) stats->best = latency;
+            if (latency > CONTROL_TICK_CYCLES) stats->over_bound++;
+            stats->total += latency;
+            stats->measured++;
+        }
+        *pending_count = 0;
+    }
+}
+
+int main(int argc, char ** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: midi_replay <isr_cycles> [messages] [sample_rate] [seed]\n"
+                        "   isr_cycles: DDS_max_cycles() measured on the board in PLAY_MIDI mode\n");
+        return 2;
+    }
+    uint64_t isr_cycles = (uint64_t)atoi(argv[1]) + ISR_ENTRY_CYCLES;
+    int messages = argc > 2 ? atoi(argv[2]) : 20000;
+    uint32_t sample_rate = argc > 3 ? (uint32_t)atoi(argv[3]) : 16000;
+    srand(argc > 4 ? atoi(argv[4]) : 1);
+
+    stream = malloc((size_t)messages * 32);
+    completes = malloc((size_t)messages * 32);
+    if (!stream || !completes) return 1;
+
+    uint8_t held[8];
+    int held_count = 0;
+    for (int i = 0; i < messages; i++) note_message(held, &held_count);
+
+    init_DDS(sample_rate);
+    init_MIDI(pluck);
+    uint64_t sample_cycles = (uint64_t)sim_TIM6.ARR + 1;
+
+    uint64_t pending[MAX_PENDING]; // receive times of messages the sample interrupt has not applied yet
+    int pending_count = 0, sent = 0;
+    latency_stats stats = {0, UINT64_MAX, 0, 0, 0};
+
+    uint64_t now = 0, next_sample = sample_cycles;
+    for (int i = 0; i < stream_len; i++) {
+        now += BYTE_CYCLES;
+        if (rand() % 4 == 0) now += rand() % (3 * BYTE_CYCLES); // idle line between bytes
+
+        // Sample interrupts that run before this byte is received
+        while (next_sample <= now) {
+            sample_interrupt(next_sample, isr_cycles, pending, &pending_count, &stats);
+            next_sample += sample_cycles;
+        }
+
+        // The byte's receive interrupt. One received during the sample interrupt has already missed
+        // it (the loop above ran that interrupt first) and waits for the next sample.
+        midi_byte(stream[i]);
+        if (completes[i] && pending_count < MAX_PENDING) pending[pending_count++] = now;
+        sent += completes[i];
+    }
+
+    // The last messages are still queued when the stream ends: keep sampling until they are heard
+    while (pending_count) {
+        sample_interrupt(next_sample, isr_cycles, pending, &pending_count, &stats);
+        next_sample += sample_cycles;
+    }
+
+    printf("%d stream bytes, %llu of %d note messages measured, %u voice steals, sample rate %u Hz, "
+           "ISR to CCR1 %llu cycles\n", stream_len, (unsigned long long)stats.measured, sent,
+           (unsigned)midi_steals(), (unsigned)sample_rate, (unsigned long long)isr_cycles);
+    if (stats.measured != (uint64_t)sent) return 1;
+    printf("note-to-PWM latency (cycles): worst %llu (%.1f us), mean %.0f, best %llu\n",
+           (unsigned long long)stats.worst, stats.worst * 1e6 / CORE_HZ,
+           (double)stats.total / stats.measured, (unsigned long long)stats.best);
+    printf("bound: one control tick = %llu cycles (%.1f us): %s (%llu messages over)\n",
+           (unsigned long long)CONTROL_TICK_CYCLES, CONTROL_TICK_CYCLES * 1e6 / CORE_HZ,
+           stats.over_bound ? "FAIL" : "ok", (unsigned long long)stats.over_bound);
+    return stats.over_bound ? 1 : 0;
+}
@@ -0,0 +1,109 @@
+// Filename: PITCH_REPORT.c
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+
+// Pitch accuracy of the TIM16 note registers, before and after the per-note PSC/ARR solver (PWM.h):
+//    -- before: the fixed PSC_PWM = 25 prescaler with ARR = 3076923 / hz - 1, truncated (the original PWM_ARR())
+//    -- after:  PWM_PSC_OPT() / PWM_ARR_OPT(), as PWM_psc() / PWM_arr() and NOTE_REGS use them
+// For every distinct pitch of Fur Elise and Minecraft (SONGS.h), and then for every named pitch from C2
+// to C8 (PITCHES.c), it prints the registers and the error of the played pitch against the requested
+// integer Hz, in cents. The solver takes the smallest PSC that fits ARR, so a few pitches land a few
+// thousandths of a cent further off than the fixed prescaler did; those are listed. Exits 1 if any
+// pitch is off by more than MAX_CENTS_AFTER after the solver.
+//
+// Build and run from lab4/fpga/src:
+//    gcc -O2 -I. -o pitch_report host/PITCH_REPORT.c PITCHES.c -lm
+//    ./pitch_report
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "PWM.h"
+#include "PITCHES.h"
+#include "SONGS.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define CORE_HZ 80000000.0
+#define FIRST_MIDI 36 // C2
+#define LAST_MIDI 108 // C8
+#define MAX_CENTS_AFTER 0.05 // half a prescaled tick stays under 0.04 cents up to C8
+
+// The fixed-prescaler registers the player used before the solver
+#define OLD_CLK (80000000 / (PSC_PWM + 1))
+#define OLD_ARR(hz) ((OLD_CLK / (hz)) - 1)
+
+#define NOTE_HZ_MS(name, ms) {PITCH_HZ(name), ms},
+static const int fur_elise_song[][2] = { FUR_ELISE_SONG(NOTE_HZ_MS) };
+static const int minecraft_notes[][2] = { MINECRAFT_NOTES(NOTE_HZ_MS) };
+
+static int failures = 0, closer_before = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+// Report
+///////////////////////////////////////////////////////////////////////////////
+
+static double cents(int hz, uint32_t psc, uint32_t arr) {
+    double played = CORE_HZ / ((double)(psc + 1) * (arr + 1));
+    return 1200.0 * log2(played / hz);
+}
+
+// Prints one pitch (always when verbose) and returns its errors before and after
+static void pitch_line(int hz, int verbose, double * before, double * after) {
+    uint32_t old_arr = OLD_ARR(hz);
+    uint32_t psc = PWM_PSC_OPT(hz), arr = PWM_ARR_OPT(hz);
+    *before = cents(hz, PSC_PWM, old_arr);
+    *after = cents(hz, psc, arr);
+    int bad = fabs(*after) > MAX_CENTS_AFTER;
+    int closer = fabs(*after) > fabs(*before) + 1e-9;
+    failures += bad;
+    closer_before += closer;
+    if (verbose || bad || closer) {
+        printf("  %5d Hz   PSC %2d ARR %5u  %+8.4f   PSC %2u ARR %5u  %+8.4f%s\n", hz, PSC_PWM, old_arr, *before,
+               psc, arr, *after, bad ? "  FAIL" : closer ? "  (before closer)" : "");
+    }
+}
+
+static void song_report(const char * name, const int (*song)[2], int len) {
+    int seen[20000] = {0};
+    double worst_before = 0, worst_after = 0;
+    int worst_before_hz = 0, worst_after_hz = 0;
+
+    printf("%s:\n  %8s   %-16s %9s   %-16s %9s\n", name, "pitch", "before", "cents", "after", "cents");
+    for (int i = 0; i < len; i++) {
+        int hz = song[i][0];
+        if (hz == 0 || song[i][1] == 0 || seen[hz]) continue;
+        seen[hz] = 1;
+        double before, after;
+        pitch_line(hz, 1, &before, &after);
+        if (fabs(before) > fabs(worst_before)) { worst_before = before; worst_before_hz = hz; }
+        if (fabs(after) > fabs(worst_after)) { worst_after = after; worst_after_hz = hz; }
+    }
+    printf("  worst: before %+.4f cents (%d Hz), after %+.4f cents (%d Hz)\n\n", worst_before, worst_before_hz,
+           worst_after, worst_after_hz);
+}
+
+int main(void) {
+    song_report("Fur Elise", fur_elise_song, sizeof(fur_elise_song) / sizeof(fur_elise_song[0]));
+    song_report("Minecraft", minecraft_notes, sizeof(minecraft_notes) / sizeof(minecraft_notes[0]));
+
+    // Every named pitch, C2 to C8: only the ones worth a look are printed
+    closer_before = 0;
+    printf("C2..C8:\n");
+    double worst_before = 0, worst_after = 0;
+    int worst_before_hz = 0, worst_after_hz = 0;
+    for (int midi = FIRST_MIDI; midi <= LAST_MIDI; midi++) {
+        int hz = pitch_hz(midi);
+        double before, after;
+        pitch_line(hz, 0, &before, &after);
+        if (fabs(before) > fabs(worst_before)) { worst_before = before; worst_before_hz = hz; }
+        if (fabs(after) > fabs(worst_after)) { worst_after = after; worst_after_hz = hz; }
+    }
+    printf("  worst: before %+.4f cents (%d Hz), after %+.4f cents (%d Hz), before closer for %d of %d\n",
+           worst_before, worst_before_hz, worst_after, worst_after_hz, closer_before, LAST_MIDI - FIRST_MIDI + 1);
+    printf("%s\n", failures ? "FAIL" : "ok: every pitch within 0.05 cents after the solver");
+    return failures ? 1 : 0;
+}
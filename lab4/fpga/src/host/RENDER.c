@@ -0,0 +1,626 @@
+// Filename: RENDER.c
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+
+// Host-side renderer for the lab4 player. Links the real PWM.c, TIMER.c, SEQUENCER.c, PWM_DMA.c and DDS.c
+// against simulated TIM6/TIM15/TIM16/DMA1 register blocks (the headers switch to sim_X when __ARM_ARCH is
+// not defined), steps simulated time in 80 MHz core cycles and:
+//    -- renders the TIM16_CH1 pin level to a 16-bit mono WAV (pin level averaged over each sample)
+//    -- measures every note in the rendered samples: the pitch from the rising edges (square wave) or
+//       the rising mid-level crossings (DDS sine) inside the note, the duration between the firmware's
+//       note boundaries (sequencer events, the delaying() calls of play_song_DDS(), or the update event
+//       that loads a note's first DMA record; the last DMA note ends when song_dma_playing() drops)
+//    -- checks period continuity: every pulse of the square wave is a whole period of its note
+//    -- writes a JSON report with the frequency (cents) and duration (ms) error of every note, and
+//       exits with 1 when a note is over the thresholds (or sounds when it should be silent), or when
+//       a click-free or DMA note change cut a period short
+//
+// Build and run from lab4/fpga/src:
+//    gcc -O2 -I. -o render host/RENDER.c PWM.c TIMER.c SEQUENCER.c PACKED_SONG.c PITCHES.c DDS.c ENVELOPE.c PWM_DMA.c -lm
+//    ./render fur_elise packed fur_elise.wav fur_elise.json
+//
+// Usage: render <fur_elise|minecraft|one_note|short_rest> <hz|regs|packed|dds|dma> <out.wav> <out.json> [click_free] [tempo]
+//               [transpose] [max_cents] [max_duration_pct]
+//    -- one_note: a single A4 (compile_song() gives 2 records: the shortest DMA song)
+//    -- short_rest: C2, a 5 ms rest, A4 (the rest ends before the C2 period does)
+//    -- click_free: PWM_click_free() argument, 1 (as in main.c) by default
+//    -- tempo, transpose: playback.tempo (Q8.8, 256 by default) and playback.transpose (semitones);
+//       the sequencer modes only, dds and dma play the table as written (as main.c does)
+//    -- max_cents: pitch threshold, 5 cents by default
+//    -- max_duration_pct: duration threshold in percent of the note, 1 by default (DELAY_TICKS() rounds to
+//       the 37.5 us TIM15 count: 0.4% of a 5 ms rest at most)
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "PWM.h"
+#include "TIMER.h"
+#include "SEQUENCER.h"
+#include "PACKED_SONG.h"
+#include "PWM_DMA.h"
+#include "DDS.h"
+#include "SONGS.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define CORE_HZ 80000000ULL
+#define PWM_SAMPLE_RATE 48000
+#define DDS_SAMPLE_RATE 40000 // 2 carrier periods per sample: the average is the duty, no carrier left
+#define MAX_NOTES 1024
+#define MAX_SECONDS 600 // stop a song that never ends
+#define DDS_HYSTERESIS 0.02 // a crossing counts once the level went this far below mid-level
+#define MAX_RECORDS 1024
+#define PERIOD_TOLERANCE 0.001 // a whole PWM period matches its note's measured period to 0.1%
+
+// Same song expansions as main.c
+#define NOTE_HZ_MS(name, ms) {PITCH_HZ(name), ms},
+static const int fur_elise_song[][2] = { FUR_ELISE_SONG(NOTE_HZ_MS) };
+static const int minecraft_notes[][2] = { MINECRAFT_NOTES(NOTE_HZ_MS) };
+
+#define NOTE_REGS_OF(name, ms) NOTE_REGS(PITCH_HZ(name), ms)
+static const note_regs fur_elise_regs[] = { FUR_ELISE_SONG(NOTE_REGS_OF) };
+static const note_regs minecraft_regs[] = { MINECRAFT_NOTES(NOTE_REGS_OF) };
+
+#define FUR_ELISE_PACKED(name, ms) NOTE_PACKED(name, ms, FUR_ELISE_TEMPO)
+#define MINECRAFT_PACKED(name, ms) NOTE_PACKED(name, ms, MINECRAFT_TEMPO)
+static const uint16_t fur_elise_notes[] = { FUR_ELISE_SONG(FUR_ELISE_PACKED) };
+static const uint16_t minecraft_packed_notes[] = { MINECRAFT_NOTES(MINECRAFT_PACKED) };
+static const packed_song fur_elise_packed = { FUR_ELISE_TEMPO, sizeof(fur_elise_notes) / sizeof(fur_elise_notes[0]), fur_elise_notes };
+static const packed_song minecraft_packed = { MINECRAFT_TEMPO, sizeof(minecraft_packed_notes) / sizeof(minecraft_packed_notes[0]), minecraft_packed_notes };
+
+#define ONE_NOTE_SONG(N) N(A4, 200)
+#define ONE_NOTE_PACKED(name, ms) NOTE_PACKED(name, ms, 100)
+static const int one_note_song[][2] = { ONE_NOTE_SONG(NOTE_HZ_MS) };
+static const note_regs one_note_regs[] = { ONE_NOTE_SONG(NOTE_REGS_OF) };
+static const uint16_t one_note_notes[] = { ONE_NOTE_SONG(ONE_NOTE_PACKED) };
+static const packed_song one_note_packed = { 100, 1, one_note_notes };
+
+// A rest shorter than what is left of the low note's period: the rest is still only staged when the
+// next note comes, and that note must wait for the period to end rather than cut it (click)
+#define SHORT_REST_SONG(N) N(C2, 100) N(REST, 5) N(A4, 100)
+#define SHORT_REST_PACKED(name, ms) NOTE_PACKED(name, ms, 5)
+static const int short_rest_song[][2] = { SHORT_REST_SONG(NOTE_HZ_MS) };
+static const note_regs short_rest_regs[] = { SHORT_REST_SONG(NOTE_REGS_OF) };
+static const uint16_t short_rest_notes[] = { SHORT_REST_SONG(SHORT_REST_PACKED) };
+static const packed_song short_rest_packed = { 5, 3, short_rest_notes };
+
+// A song in every form the modes play
+typedef struct
+{
+  const char * name;
+  const int (*hz)[2];           // hz, dds and dma modes
+  int len;
+  const note_regs * regs;       // regs mode
+  const packed_song * packed;   // packed mode
+} render_song;
+
+#define SONG_LEN(table) (int)(sizeof(table) / sizeof(table[0]))
+static const render_song songs[] = {
+    { "fur_elise", fur_elise_song, SONG_LEN(fur_elise_song), fur_elise_regs, &fur_elise_packed },
+    { "minecraft", minecraft_notes, SONG_LEN(minecraft_notes), minecraft_regs, &minecraft_packed },
+    { "one_note", one_note_song, SONG_LEN(one_note_song), one_note_regs, &one_note_packed },
+    { "short_rest", short_rest_song, SONG_LEN(short_rest_song), short_rest_regs, &short_rest_packed },
+};
+
+// Simulated peripherals (referenced by PWM.h, TIMER.h, SEQUENCER.h, PWM_DMA.h, DDS.h and STM32L432KC_RCC.h
+// in the host build)
+TIM16_TypeDef sim_TIM16;
+TIM15_TypeDef sim_TIM15;
+TIM6_TypeDef sim_TIM6;
+RCC_TypeDef sim_RCC;
+DMA_TypeDef sim_DMA1;
+DMA_Channel_TypeDef sim_DMA1_Channel6;
+uint32_t sim_DMA1_CSELR, sim_NVIC_ISER0, sim_NVIC_ISER1, sim_DEMCR, sim_DWT_CTRL, sim_DWT_CYCCNT;
+
+void TIM1_BRK_TIM15_IRQHandler(void);
+void TIM6_DAC_IRQHandler(void);
+void DMA1_Channel6_IRQHandler(void);
+void TIM1_UP_TIM16_IRQHandler(void);
+
+// Counter state the firmware cannot see: position in the period and the active (shadow) registers
+typedef struct
+{
+  uint64_t pos;      // core cycles into the current counter period
+  uint32_t psc;      // active prescaler
+  uint32_t arr;      // active ARR (used when ARPE = 1)
+  uint32_t ccr1;     // active CCR1 (used when OC1PE = 1)
+  uint32_t rep;      // repetition counter: overflows left before the next update event
+  uint32_t cnt_seen; // CNT as last published, to spot firmware writes
+  uint32_t updates;  // update events so far
+} sim_timer;
+
+// The parts of TIM15/TIM16 the simulation needs (same offsets in both blocks)
+typedef struct
+{
+  volatile uint32_t * cr1, * dier, * sr, * egr, * ccmr1, * cnt, * psc, * arr, * rcr, * ccr1;
+} timer_regs;
+
+// One played note: the firmware's boundaries and what the samples in between show
+typedef struct
+{
+  uint64_t start;    // core cycle of the note boundary (sequencer event, DDS note change or DMA record)
+  uint64_t end;
+  int edges;         // rising edges (or rising mid-level crossings) in the rendered samples
+  double hz;         // measured from the first to the last of them, 0 = silent
+} note_log;
+
+static note_log notes[MAX_NOTES];
+static int note_count = 0;
+
+// Simulation state
+static timer_regs r15, r16;
+static sim_timer t15, t16;
+static uint64_t now = 0, high = 0, sample_start = 0, next_tim6 = 0;
+static uint32_t sample_rate = PWM_SAMPLE_RATE;
+static uint32_t tim16_updates_seen = 0;
+
+// DMA playback: the words DMA1 channel 6 reads (CMAR cannot hold a host pointer, so the model takes
+// them from the array play_song_dma() was given) and the first record of every note
+static pwm_record records[MAX_RECORDS];
+static const uint32_t * dma_words;
+static uint32_t dma_sent = 0;
+static int note_first[MAX_NOTES + 1];
+static int dma_record = -1;  // record live on TIM16
+static int dma_len = 0;      // notes of the DMA song
+
+// Rendered pin level, 0..1 per sample
+static float * levels;
+static uint32_t samples = 0, samples_max = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+// Timer model
+///////////////////////////////////////////////////////////////////////////////
+
+static uint32_t active_arr(const timer_regs * r, const sim_timer * t) {
+    return (*r->cr1 & (1 << 7)) ? t->arr : *r->arr; // ARPE
+}
+
+static uint32_t active_ccr1(const timer_regs * r, const sim_timer * t) {
+    return (*r->ccmr1 & (1 << 3)) ? t->ccr1 : *r->ccr1; // OC1PE
+}
+
+// The counter is blocked while CEN = 0 or ARR = 0
+static int running(const timer_regs * r, const sim_timer * t) {
+    return (*r->cr1 & 1) && active_arr(r, t) != 0;
+}
+
+static uint64_t period(const timer_regs * r, const sim_timer * t) {
+    return (uint64_t)(t->psc + 1) * (active_arr(r, t) + 1);
+}
+
+// Update event: preload registers -> active registers, counter back to 0
+static void update_event(const timer_regs * r, sim_timer * t, int set_uif) {
+    t->psc = *r->psc;
+    t->arr = *r->arr;
+    t->ccr1 = *r->ccr1;
+    t->rep = *r->rcr & 0xFF;
+    t->pos = 0;
+    t->updates++;
+    if (set_uif) *r->sr |= 1; // UIF
+}
+
+static void publish_cnt(const timer_regs * r, sim_timer * t) {
+    t->cnt_seen = (uint32_t)(t->pos / (t->psc + 1));
+    *r->cnt = t->cnt_seen;
+}
+
+// Applies what the firmware just wrote: CNT writes and the UG bit
+static void sync(const timer_regs * r, sim_timer * t) {
+    if (*r->cnt != t->cnt_seen) t->pos = (uint64_t)*r->cnt * (t->psc + 1);
+    if (*r->egr & 1) {
+        *r->egr = 0;
+        update_event(r, t, !(*r->cr1 & (1 << 2))); // URS: UG does not raise UIF
+    }
+    publish_cnt(r, t);
+}
+
+// Cycles until the counter overflows (UINT64_MAX when blocked)
+static uint64_t to_overflow(const timer_regs * r, const sim_timer * t) {
+    if (!running(r, t)) return UINT64_MAX;
+    uint64_t p = period(r, t);
+    return (t->pos < p) ? p - t->pos : 1;
+}
+
+// Advances by dt cycles (never past an overflow). Returns the cycles the CH1 pin spent high.
+static uint64_t advance(const timer_regs * r, sim_timer * t, uint64_t dt) {
+    uint64_t high_end = (uint64_t)active_ccr1(r, t) * (t->psc + 1); // PWM mode 1: high while CNT < CCR1
+
+    if (!running(r, t)) {
+        publish_cnt(r, t);
+        return (t->pos < high_end) ? dt : 0;
+    }
+
+    uint64_t high = 0;
+    if (t->pos < high_end) high = (high_end - t->pos < dt) ? high_end - t->pos : dt;
+
+    t->pos += dt;
+    if (t->pos >= period(r, t)) {
+        if (*r->cr1 & (1 << 1)) t->pos = 0;     // UDIS: wrap without an update event
+        else if (t->rep > 0) { t->rep--; t->pos = 0; } // repetition counter: wrap, no update event yet
+        else update_event(r, t, 1);
+    }
+    publish_cnt(r, t);
+    return high;
+}
+
+static void bind(timer_regs * r, volatile uint32_t * cr1, volatile uint32_t * dier, volatile uint32_t * sr,
+                 volatile uint32_t * egr, volatile uint32_t * ccmr1, volatile uint32_t * cnt,
+                 volatile uint32_t * psc, volatile uint32_t * arr, volatile uint32_t * rcr, volatile uint32_t * ccr1) {
+    r->cr1 = cr1; r->dier = dier; r->sr = sr; r->egr = egr; r->ccmr1 = ccmr1;
+    r->cnt = cnt; r->psc = psc; r->arr = arr; r->rcr = rcr; r->ccr1 = ccr1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Simulation
+///////////////////////////////////////////////////////////////////////////////
+
+// Core cycle where output sample k starts
+static uint64_t sample_time(uint32_t k) {
+    return (uint64_t)k * CORE_HZ / sample_rate;
+}
+
+static void begin_note(void) {
+    if (note_count < MAX_NOTES) notes[note_count++].start = now;
+}
+
+static void end_note(void) {
+    if (note_count > 0) notes[note_count - 1].end = now;
+}
+
+// DMA1 channel 6 serving a TIM16 update request: a burst of DBL + 1 words into TIM16 from DBA on
+static void dma_request(void) {
+    if (!(TIM16->DIER & (1 << 8)) || !(DMA1_Channel6->CCR & 1) || DMA1_Channel6->CNDTR == 0) return; // UDE, EN
+
+    volatile uint32_t * regs = (volatile uint32_t *)TIM16;
+    uint32_t dba = TIM16->DCR & 0x1F, dbl = (TIM16->DCR >> 8) & 0x1F;
+    for (uint32_t k = 0; k <= dbl && DMA1_Channel6->CNDTR > 0; k++) {
+        regs[dba + k] = dma_words[dma_sent++];
+        DMA1_Channel6->CNDTR--;
+    }
+    if (DMA1_Channel6->CNDTR == 0) {
+        DMA1->ISR |= (1 << 21) | (1 << 20); // TCIF6, GIF6
+        if ((DMA1_Channel6->CCR & (1 << 1)) && (sim_NVIC_ISER0 & (1 << DMA1_Channel6_IRQn))) {
+            DMA1_Channel6_IRQHandler();
+            DMA1->ISR &= ~DMA1->IFCR;
+            DMA1->IFCR = 0;
+        }
+    }
+}
+
+// What follows a TIM16 update event: the DMA burst, the note boundary of a DMA song, the TIM16 interrupt
+static void tim16_updates(void) {
+    while (tim16_updates_seen != t16.updates) {
+        tim16_updates_seen++;
+        if (dma_record >= 0 || (TIM16->DIER & (1 << 8))) {
+            dma_record++;
+            if (note_count < dma_len && dma_record == note_first[note_count]) {
+                end_note();
+                begin_note();
+            }
+        }
+        dma_request();
+    }
+    if ((TIM16->SR & 1) && (TIM16->DIER & 1) && (sim_NVIC_ISER0 & (1 << TIM16_IRQn))) TIM1_UP_TIM16_IRQHandler();
+}
+
+static void sync16(void) {
+    sync(&r16, &t16);
+    tim16_updates();
+}
+
+// Sequencer events: the note boundaries as the firmware sees them
+static void on_event(const player_event * event) {
+    end_note();
+    if (event->type == PLAYER_NOTE_DONE) begin_note();
+}
+
+// Advances to the next event: the end of an output sample, a counter overflow or a TIM6 sample interrupt
+static void step(void) {
+    uint64_t next_sample = sample_time(samples + 1);
+    int tim6_on = (TIM6->CR1 & 1) && (TIM6->DIER & 1) && (sim_NVIC_ISER1 & (1 << (TIM6_IRQn - 32)));
+
+    uint64_t dt = next_sample - now;
+    uint64_t d15 = to_overflow(&r15, &t15), d16 = to_overflow(&r16, &t16);
+    if (d15 < dt) dt = d15;
+    if (d16 < dt) dt = d16;
+    if (tim6_on && next_tim6 - now < dt) dt = next_tim6 - now;
+
+    high += advance(&r16, &t16, dt);
+    advance(&r15, &t15, dt);
+    now += dt;
+    tim16_updates();
+
+    // DDS sample interrupt (TIM6 UIE, enabled in the NVIC)
+    if (tim6_on && now == next_tim6) {
+        TIM6->SR |= 1;
+        TIM6_DAC_IRQHandler();
+        sync16();
+        next_tim6 += (uint64_t)(TIM6->PSC + 1) * (TIM6->ARR + 1);
+    }
+
+    // Sequencer interrupt (TIM15 UIE, enabled in the NVIC); the main loop then picks up its event
+    if ((*r15.sr & 1) && (*r15.dier & 1) && (sim_NVIC_ISER0 & (1 << TIM15_IRQn))) {
+        TIM1_BRK_TIM15_IRQHandler();
+        sync(&r15, &t15);
+        sync16();
+        player_poll();
+    }
+
+    if (now == next_sample) {
+        if (samples == samples_max) {
+            samples_max = samples_max ? 2 * samples_max : 1 << 20;
+            levels = realloc(levels, samples_max * sizeof(float));
+            if (!levels) { fprintf(stderr, "out of memory\n"); exit(1); }
+        }
+        levels[samples++] = (float)((double)high / (now - sample_start));
+        high = 0;
+        sample_start = now;
+    }
+}
+
+// init_DDS() starts TIM6 from 0 (UG): its first sample interrupt comes one period later
+static void sim_init_DDS(uint32_t rate) {
+    init_DDS(rate);
+    sync16();
+    next_tim6 = now + (uint64_t)(TIM6->PSC + 1) * (TIM6->ARR + 1);
+}
+
+// delaying() as the simulation runs it: the same register writes, then simulated time until UIF
+static void sim_delaying(int ms) {
+    TIM15->CNT = 0;
+    TIM15->ARR = delay_ticks(ms) - 1;
+    TIM15->EGR |= 1;
+    sync(&r15, &t15);
+    TIM15->SR &= ~(1);
+    while (!(TIM15->SR & 1) && now < MAX_SECONDS * CORE_HZ) step();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Measurement
+///////////////////////////////////////////////////////////////////////////////
+
+// Rising edges of a square wave, to a fraction of a sample: the level of the sample holding the edge
+// is the part of it spent high after the edge (every PWM note stays high and low for several samples)
+static int square_edges(uint32_t from, uint32_t to, double * first, double * last) {
+    int edges = 0;
+    for (uint32_t k = (from > 0) ? from : 1; k < to; k++) {
+        if (levels[k - 1] > 0 || levels[k] <= 0) continue;
+        double t = sample_time(k + 1) - levels[k] * (double)(sample_time(k + 1) - sample_time(k));
+        if (edges++ == 0) *first = t;
+        *last = t;
+    }
+    return edges;
+}
+
+// Rising crossings of the mid-level (silence) by a DDS tone, interpolated between sample centres
+static int dds_edges(uint32_t from, uint32_t to, double * first, double * last) {
+    int edges = 0, armed = 0;
+    for (uint32_t k = (from > 0) ? from : 1; k < to; k++) {
+        if (levels[k - 1] < 0.5 - DDS_HYSTERESIS) armed = 1;
+        if (!armed || levels[k - 1] >= 0.5 || levels[k] < 0.5) continue;
+        double c0 = (sample_time(k - 1) + sample_time(k)) / 2.0, c1 = (sample_time(k) + sample_time(k + 1)) / 2.0;
+        double t = c0 + (c1 - c0) * (0.5 - levels[k - 1]) / (levels[k] - levels[k - 1]);
+        if (edges++ == 0) *first = t;
+        *last = t;
+        armed = 0;
+    }
+    return edges;
+}
+
+static void measure_notes(int dds) {
+    for (int i = 0; i < note_count; i++) {
+        uint32_t from = (uint32_t)((notes[i].start * sample_rate + CORE_HZ - 1) / CORE_HZ); // first whole sample
+        uint32_t to = (uint32_t)(notes[i].end * sample_rate / CORE_HZ);
+        if (to > samples) to = samples;
+        double first = 0, last = 0;
+        notes[i].edges = (from < to) ? (dds ? dds_edges(from, to, &first, &last) : square_edges(from, to, &first, &last)) : 0;
+        notes[i].hz = (notes[i].edges >= 2) ? (notes[i].edges - 1) * (double)CORE_HZ / (last - first) : 0;
+    }
+}
+
+// Index of the note holding core cycle t, searching from note i on (note_count past the last one)
+static int note_at(double t, int i) {
+    while (i < note_count && t >= notes[i].end) i++;
+    return i;
+}
+
+// Checks one pulse of the square wave: rise, fall (-1 if none was seen) and the next rise.
+// A pulse that starts in a sounding note must be a whole period of it: high for half the period and
+// the next rise one period later, or later than that when a rest (or the end of the song) follows.
+static int whole_period(double rise, double fall, double next, int * i) {
+    *i = note_at(rise + 1, *i); // a rise on a note boundary (DMA update event) is the new note's
+    if (*i >= note_count || notes[*i].hz == 0) return 1; // sound during a rest fails the pitch check
+    double p = CORE_HZ / notes[*i].hz;
+    if (fall < 0 || fabs(fall - rise - p / 2) > PERIOD_TOLERANCE * p) return 0;
+
+    int j = note_at(next, *i), rest_between = (j >= note_count);
+    for (int m = *i + 1; m <= j && m < note_count; m++) if (notes[m].hz == 0) rest_between = 1;
+    if (rest_between) return next - rise >= p * (1 - PERIOD_TOLERANCE);
+    return fabs(next - rise - p) <= PERIOD_TOLERANCE * p;
+}
+
+// Period continuity: the pulses of the rendered square wave that are not whole periods of their note,
+// i.e. the clicks of a note change that cut the running period short
+static int broken_periods(void) {
+    int broken = 0, i = 0;
+    double rise = -1, fall = -1;
+    for (uint32_t k = 1; k < samples; k++) {
+        double len = (double)(sample_time(k + 1) - sample_time(k));
+        if (levels[k - 1] >= 1 && levels[k] < 1 && rise >= 0 && fall < 0) fall = sample_time(k) + levels[k] * len;
+        if (levels[k - 1] > 0 || levels[k] <= 0) continue;
+        double next = sample_time(k + 1) - levels[k] * len;
+        if (rise >= 0 && !whole_period(rise, fall, next, &i)) broken++;
+        rise = next;
+        fall = -1;
+    }
+    return broken;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Output files
+///////////////////////////////////////////////////////////////////////////////
+
+static void put_u32(FILE * f, uint32_t v) { fputc(v, f); fputc(v >> 8, f); fputc(v >> 16, f); fputc(v >> 24, f); }
+static void put_u16(FILE * f, uint16_t v) { fputc(v, f); fputc(v >> 8, f); }
+
+// 44-byte PCM header, then the samples: low = -16384, high = +16384
+static void write_wav(FILE * f) {
+    fwrite("RIFF", 1, 4, f); put_u32(f, 36 + samples * 2);
+    fwrite("WAVEfmt ", 1, 8, f); put_u32(f, 16);
+    put_u16(f, 1); put_u16(f, 1);                        // PCM, mono
+    put_u32(f, sample_rate); put_u32(f, sample_rate * 2);
+    put_u16(f, 2); put_u16(f, 16);                       // 16-bit
+    fwrite("data", 1, 4, f); put_u32(f, samples * 2);
+    for (uint32_t k = 0; k < samples; k++) put_u16(f, (uint16_t)(int16_t)lrint((2 * levels[k] - 1) * 16384));
+}
+
+static double transposed_hz(int hz, int sequenced) {
+    return sequenced ? hz * pow(2.0, playback.transpose / 12.0) : hz;
+}
+
+static double scaled_ms(int ms, int sequenced) {
+    return sequenced ? ms * (double)TEMPO_NORMAL / playback.tempo : ms;
+}
+
+// Writes the report; returns the number of notes over a threshold (or with the wrong note count),
+// plus the broken periods when every note change should wait for the end of a period.
+// DMA notes last whole PWM periods (compile_song() rounds), so they may also be off by half a period.
+static int write_report(FILE * f, const char * song_name, const char * mode, const int (*song)[2], int len,
+                        int sequenced, int dma, int broken, int whole_periods, double max_cents, double max_pct) {
+    double worst_cents = 0, worst_ms = 0, total_expected = 0, total_actual = 0;
+    int failed = (note_count != len) ? 1 : 0;
+    if (whole_periods) failed += broken;
+
+    fprintf(f, "{\n  \"song\": \"%s\",\n  \"mode\": \"%s\",\n", song_name, mode);
+    fprintf(f, "  \"click_free\": %d,\n  \"tempo\": %d,\n  \"transpose\": %d,\n  \"sample_rate\": %u,\n",
+            PWM_is_click_free(), playback.tempo, playback.transpose, (unsigned)sample_rate);
+    fprintf(f, "  \"notes\": [\n");
+    for (int i = 0; i < note_count; i++) {
+        int expected_hz = (i < len) ? song[i][0] : 0;
+        double expected_ms = (i < len) ? scaled_ms(song[i][1], sequenced) : 0;
+        double target = transposed_hz(expected_hz, sequenced);
+        double actual_ms = (notes[i].end - notes[i].start) * 1000.0 / CORE_HZ;
+        double cents = (target > 0 && notes[i].hz > 0) ? 1200.0 * log2(notes[i].hz / target) : 0;
+        int pitch_ok = (target > 0) == (notes[i].hz > 0) && fabs(cents) <= max_cents;
+        double allowed_ms = expected_ms * max_pct / 100;
+        double half_period_ms = 500.0 / (expected_hz ? expected_hz : PWM_REST_FREQ);
+        if (dma && allowed_ms < half_period_ms) allowed_ms = half_period_ms;
+        int duration_ok = fabs(actual_ms - expected_ms) <= allowed_ms;
+
+        if (fabs(cents) > fabs(worst_cents)) worst_cents = cents;
+        if (fabs(actual_ms - expected_ms) > fabs(worst_ms)) worst_ms = actual_ms - expected_ms;
+        total_expected += expected_ms;
+        total_actual += actual_ms;
+        if (!pitch_ok || !duration_ok) failed++;
+
+        fprintf(f, "    {\"index\": %d, \"expected_hz\": %.3f, \"actual_hz\": %.3f, \"edges\": %d, \"cents_error\": %.4f, "
+                   "\"expected_ms\": %.3f, \"actual_ms\": %.3f, \"duration_error_ms\": %.3f, \"pitch_ok\": %s, "
+                   "\"duration_ok\": %s}%s\n",
+                i, target, notes[i].hz, notes[i].edges, cents, expected_ms, actual_ms, actual_ms - expected_ms,
+                pitch_ok ? "true" : "false", duration_ok ? "true" : "false", (i + 1 < note_count) ? "," : "");
+    }
+    fprintf(f, "  ],\n");
+    fprintf(f, "  \"summary\": {\"notes\": %d, \"expected_notes\": %d, \"worst_cents_error\": %.4f, "
+               "\"worst_duration_error_ms\": %.3f, \"expected_total_ms\": %.3f, \"actual_total_ms\": %.3f, "
+               "\"broken_periods\": %d, \"max_cents\": %.3f, \"max_duration_pct\": %.3f, \"failed\": %d}\n}\n",
+            note_count, len, worst_cents, worst_ms, total_expected, total_actual, broken, max_cents, max_pct, failed);
+    return failed;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Main
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char ** argv) {
+    if (argc < 5) {
+        fprintf(stderr, "usage: %s <fur_elise|minecraft|one_note|short_rest> <hz|regs|packed|dds|dma> <out.wav> <out.json> "
+                        "[click_free] [tempo] [transpose] [max_cents] [max_duration_pct]\n", argv[0]);
+        return 2;
+    }
+
+    const render_song * entry = 0;
+    for (int i = 0; i < SONG_LEN(songs); i++) if (strcmp(argv[1], songs[i].name) == 0) entry = &songs[i];
+    if (!entry) { fprintf(stderr, "unknown song %s\n", argv[1]); return 2; }
+    const int (*song)[2] = entry->hz;
+    int len = entry->len;
+    while (len > 0 && song[len - 1][1] == 0) len--; // the end marker is not a note
+
+    const char * mode = argv[2];
+    int dds = (strcmp(mode, "dds") == 0), dma = (strcmp(mode, "dma") == 0);
+    if (!dds && !dma && strcmp(mode, "regs") != 0 && strcmp(mode, "packed") != 0 && strcmp(mode, "hz") != 0) {
+        fprintf(stderr, "unknown mode %s\n", mode);
+        return 2;
+    }
+    double max_cents = argc > 8 ? atof(argv[8]) : 5;
+    double max_pct = argc > 9 ? atof(argv[9]) : 1;
+
+    FILE * wav = fopen(argv[3], "wb");
+    FILE * json = fopen(argv[4], "w");
+    if (!wav || !json) { fprintf(stderr, "cannot open output files\n"); return 1; }
+
+    bind(&r15, &TIM15->CR1, &TIM15->DIER, &TIM15->SR, &TIM15->EGR, &TIM15->CCMR1_out, &TIM15->CNT, &TIM15->PSC, &TIM15->ARR,
+         &TIM15->RCR, &TIM15->CCR1);
+    bind(&r16, &TIM16->CR1, &TIM16->DIER, &TIM16->SR, &TIM16->EGR, &TIM16->CCMR1_out, &TIM16->CNT, &TIM16->PSC, &TIM16->ARR,
+         &TIM16->RCR, &TIM16->CCR1);
+    TIM15->ARR = TIM16->ARR = 0xFFFF; // reset values
+    t15.arr = t16.arr = 0xFFFF;
+
+    // Same start-up as main.c
+    init_PWM();
+    sync16();
+    PWM_click_free(argc > 5 ? atoi(argv[5]) : 1);
+    init_delaying();
+    sync(&r15, &t15);
+    if (argc > 6) playback.tempo = (uint16_t)atoi(argv[6]);
+    if (argc > 7) playback.transpose = (int8_t)atoi(argv[7]);
+
+    if (dds) {
+        // play_song_DDS() from main.c, with delaying() run by the simulation
+        sample_rate = DDS_SAMPLE_RATE;
+        sim_init_DDS(16000);
+        DDS_waveform(DDS_SINE);
+        for (int i = 0; i < len; i++) {
+            begin_note();
+            DDS_frequency(song[i][0]);
+            sim_delaying(song[i][1]);
+            end_note();
+        }
+        DDS_frequency(0);
+    } else if (dma) {
+        // First record of every note: what compile_song() makes of the notes before it
+        for (int i = 0; i <= len; i++) note_first[i] = (i == 0) ? 0 : compile_song(song, i, records, MAX_RECORDS) - 1;
+        int count = compile_song(song, len, records, MAX_RECORDS);
+        if (count < 2) { fprintf(stderr, "%s does not fit %d records\n", argv[1], MAX_RECORDS); return 1; }
+        dma_len = len;
+        dma_words = (const uint32_t *)&records[1];
+        play_song_dma(records, count);
+        sync16();
+        while (song_dma_playing() && now < MAX_SECONDS * CORE_HZ) step();
+        end_note();
+    } else {
+        player_on_event(on_event);
+        if (strcmp(mode, "regs") == 0) play_song_regs(entry->regs, len);
+        else if (strcmp(mode, "packed") == 0) play_song_packed(entry->packed);
+        else play_song(song, len);
+        sync(&r15, &t15);
+        sync16();
+        if (song_playing()) begin_note();
+        while (song_playing() && now < MAX_SECONDS * CORE_HZ) step();
+    }
+
+    measure_notes(dds);
+    write_wav(wav);
+    fclose(wav);
+    int broken = dds ? 0 : broken_periods();
+    int failed = write_report(json, argv[1], mode, song, len, !dds && !dma, dma, broken, dma || PWM_is_click_free(),
+                              max_cents, max_pct);
+    fclose(json);
+
+    printf("%s/%s: %d notes, %.3f s rendered, %d broken periods, %d failed (%.1f cents, %.1f%% duration)\n",
+           argv[1], mode, note_count, (double)now / CORE_HZ, broken, failed, max_cents, max_pct);
+    return failed ? 1 : 0;
+}
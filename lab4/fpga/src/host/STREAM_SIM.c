@@ -0,0 +1,216 @@
+// Filename: STREAM_SIM.c
+// Marina Bellido: mbellido@hmc.edu
+// Oct 3, 2025
+
+// Host simulation of the PLAY_STREAM protocol (SONG_STREAM.h). Links the real SONG_STREAM.c against a
+// model of the USART2 driver (STM32L432KC_USART.h) that moves bytes at the wire rate in both directions,
+// and plays both ends:
+//    -- host: streams several songs back to back, one block per credit, with random block lengths
+//       (full STREAM_HALF blocks, short blocks closed by STREAM_BLOCK_END, now and then an empty one),
+//       and random pauses before a block so the player runs dry mid-song
+//    -- board: main()'s PLAY_STREAM loop, stream_start() then stream_next() at every note change, as
+//       the sequencer's TIM15 interrupt calls it; the next song starts as soon as the last one ends
+// Checks: every song plays back note for note (underrun rests aside) without stalling, no byte is dropped, and once
+// everything is played the host holds exactly the two credits of the two empty halves.
+//
+// Build and run from lab4/fpga/src:
+//    gcc -O2 -I. -o stream_sim host/STREAM_SIM.c SONG_STREAM.c PITCHES.c
+//    ./stream_sim
+//
+// Usage: stream_sim [songs] [seed]
+//    -- songs: songs streamed back to back, 20 by default
+//    -- seed: random song and timing seed
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SONG_STREAM.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define BYTE_NS (1000000000ULL * 10 / STREAM_BAUD) // start + 8 data + stop bits
+#define TEMPO_MS 25                                // STREAM_TEMPO in main.c
+#define MAX_SONG 300                               // notes per song, end note included
+#define MAX_SONGS 100
+#define MAX_CREDITS 8                              // credit bytes on the wire at once
+#define PAUSE_ONE_IN 8                             // blocks the host is late with, on average
+#define STALL_NS (30 * 1000000000ULL)              // no note played for this long: the stream is stuck
+
+// Songs as sent (note words, end note last) and as played
+static uint16_t songs[MAX_SONGS][MAX_SONG];
+static int song_len[MAX_SONGS];
+
+///////////////////////////////////////////////////////////////////////////////
+// USART2 driver model: the board side sees the real driver API
+///////////////////////////////////////////////////////////////////////////////
+
+static void (*receive_handler)(uint8_t byte);
+static int (*transmit_next)(uint8_t * byte);
+static int transmitting = 0;
+
+void initUSART(int baud_rate) { (void)baud_rate; }
+void USART_on_receive(void (*handler)(uint8_t byte)) { receive_handler = handler; }
+void USART_transmit(int (*next)(uint8_t * byte)) { transmit_next = next; transmitting = 1; }
+uint32_t USART_overruns(void) { return 0; } // the model never loses a byte in hardware
+
+///////////////////////////////////////////////////////////////////////////////
+// Simulation
+///////////////////////////////////////////////////////////////////////////////
+
+static uint64_t now = 0; // ns
+
+// Board -> host: credit bytes in flight, by arrival time
+static uint64_t credit_at[MAX_CREDITS];
+static int credits_in_flight = 0;
+static uint64_t tx_free = 0; // when the board's transmitter can start the next byte
+
+// Host: credits in hand, the block being sent and where it is in the songs
+static int host_credits = 0;
+static uint8_t block[2 * (STREAM_HALF + 1)];
+static int block_len = 0, block_pos = 0;
+static uint64_t next_byte = UINT64_MAX;
+static int send_song = 0, send_note = 0;
+static int blocks = 0, short_blocks = 0, empty_blocks = 0;
+
+// Pulls credit bytes from the board while its transmit interrupt is on
+static void board_transmit(void) {
+    uint8_t byte;
+    while (transmitting && credits_in_flight < MAX_CREDITS) {
+        if (!transmit_next(&byte)) {
+            transmitting = 0;
+            break;
+        }
+        if (tx_free < now) tx_free = now;
+        tx_free += BYTE_NS;
+        credit_at[credits_in_flight++] = tx_free;
+    }
+}
+
+// Builds the host's next block: up to STREAM_HALF notes of the current song
+static void host_next_block(void) {
+    block_len = block_pos = 0;
+    int notes = 0, ended = 0;
+    if (rand() % 20 == 0) {
+        empty_blocks++;
+    } else {
+        int want = (rand() % 2) ? STREAM_HALF : 1 + rand() % STREAM_HALF;
+        while (notes < want) {
+            uint16_t note = songs[send_song][send_note++];
+            block[block_len++] = note >> 8;
+            block[block_len++] = note & 0xFF;
+            notes++;
+            if (send_note == song_len[send_song]) { // end note: closes the block, next block is the next song
+                send_song++;
+                send_note = 0;
+                ended = 1;
+                break;
+            }
+        }
+    }
+    if (notes < STREAM_HALF && !ended) {
+        block[block_len++] = STREAM_BLOCK_END >> 8;
+        block[block_len++] = STREAM_BLOCK_END & 0xFF;
+        if (notes) short_blocks++;
+    }
+    blocks++;
+    uint64_t pause = (rand() % PAUSE_ONE_IN == 0) ? (uint64_t)(rand() % 2000) * 1000000 : 0;
+    next_byte = now + pause + BYTE_NS;
+}
+
+int main(int argc, char ** argv) {
+    int n_songs = argc > 1 ? atoi(argv[1]) : 20;
+    srand(argc > 2 ? atoi(argv[2]) : 1);
+    if (n_songs > MAX_SONGS) n_songs = MAX_SONGS;
+
+    int total_notes = 0;
+    for (int s = 0; s < n_songs; s++) {
+        int len = 1 + rand() % (MAX_SONG - 1); // notes before the end note
+        if (s % 5 == 0) len = STREAM_HALF - 1; // end note exactly fills a half
+        for (int i = 0; i < len; i++) {
+            int midi = (rand() % 8 == 0) ? 0 : 48 + rand() % 37;
+            songs[s][i] = PACK_NOTE(midi, 1 + rand() % 8);
+        }
+        songs[s][len] = PACK_NOTE(0, 0);
+        song_len[s] = len + 1;
+        total_notes += len;
+    }
+
+    // Board: main()'s PLAY_STREAM loop
+    init_stream();
+    int play_song = 0, play_note = 0, errors = 0;
+    uint32_t underruns = 0, overruns = 0;
+    stream_start(TEMPO_MS);
+    uint64_t next_note = 0, progress = 0;
+
+    while (play_song < n_songs) {
+        board_transmit();
+
+        // Earliest of: a credit reaching the host, a host byte reaching the board, a note change
+        uint64_t t = next_note;
+        if (credits_in_flight && credit_at[0] < t) t = credit_at[0];
+        if (next_byte < t) t = next_byte;
+        now = t;
+        if (now - progress > STALL_NS) {
+            printf("song %d stuck after note %d: no note for %llu s FAIL\n", play_song, play_note,
+                   (unsigned long long)(STALL_NS / 1000000000ULL));
+            errors++;
+            break;
+        }
+
+        if (credits_in_flight && credit_at[0] == now) {
+            for (int i = 1; i < credits_in_flight; i++) credit_at[i - 1] = credit_at[i];
+            credits_in_flight--;
+            host_credits++;
+        } else if (next_byte == now) {
+            receive_handler(block[block_pos++]);
+            next_byte = (block_pos < block_len) ? now + BYTE_NS : UINT64_MAX;
+        } else {
+            // Sequencer interrupt: next note of the streamed song
+            int frequency, duration;
+            uint32_t before = stream_underruns();
+            if (!stream_next(&frequency, &duration)) {
+                // End of song: main() starts the next one right away
+                if (play_note != song_len[play_song] - 1) {
+                    printf("song %d ended after %d of %d notes FAIL\n", play_song, play_note, song_len[play_song] - 1);
+                    errors++;
+                }
+                underruns += stream_underruns();
+                overruns += stream_overruns();
+                play_song++;
+                play_note = 0;
+                progress = now;
+                stream_start(TEMPO_MS);
+                continue;
+            }
+            if (stream_underruns() == before) {
+                uint16_t note = songs[play_song][play_note++];
+                progress = now;
+                if (frequency != pitch_hz(PACKED_MIDI(note)) || duration != PACKED_UNITS(note) * TEMPO_MS) {
+                    if (errors++ < 5) printf("song %d note %d: %d Hz %d ms, sent %d Hz %d ms FAIL\n", play_song, play_note - 1,
+                                             frequency, duration, pitch_hz(PACKED_MIDI(note)), PACKED_UNITS(note) * TEMPO_MS);
+                }
+            }
+            next_note = now + (uint64_t)duration * 1000000;
+        }
+
+        // The host sends one block per credit, one at a time
+        if (next_byte == UINT64_MAX && host_credits && send_song < n_songs) {
+            host_credits--;
+            host_next_block();
+        }
+    }
+
+    // Drain the last credits: both halves are free again, so the host must hold exactly two
+    now = UINT64_MAX - 1;
+    board_transmit();
+    host_credits += credits_in_flight;
+
+    printf("%d songs, %d notes, %d blocks (%d short, %d empty), %.1f s played\n", n_songs, total_notes, blocks,
+           short_blocks, empty_blocks, next_note / 1e9);
+    printf("underrun rests %u, bytes dropped %u, host credits at the end %d\n", underruns, overruns, host_credits);
+    int ok = errors == 0 && overruns == 0 && host_credits == 2;
+    printf("%s\n", ok ? "ok: every song played back, no byte dropped, credits balanced" : "FAIL");
+    return ok ? 0 : 1;
+}
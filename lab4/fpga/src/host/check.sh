@@ -0,0 +1,93 @@
+#!/bin/sh
+# Filename: check.sh
+# Marina Bellido: mbellido@hmc.edu
+# Oct 3, 2025
+
+# Host regression checks for the lab4 player: builds host/RENDER.c and renders the songs in every
+# playback mode. render exits 1 when a note is off pitch, too short/long or sounds during a rest,
+# or when a click-free or DMA note change cuts a PWM period short, so any failing run fails the check.
+# short_rest stages a rest that is replaced before it ever goes live (PWM_set() must not cut the period).
+# The other host tools follow: DDS mixer cost and clipping, pitch accuracy, song streaming, the MIDI
+# synthesizer's latency, cooperative playback, and midi2song's tables from a generated MIDI file.
+#
+# Run from lab4/fpga/src:
+#    sh host/check.sh
+
+set -e
+out=${TMPDIR:-/tmp}/lab4_check
+mkdir -p "$out"
+
+# main.c in every playback mode, warnings as errors (the target register headers, as on the board)
+for mode in PLAY_DMA PLAY_REGS PLAY_PACKED PLAY_DDS PLAY_STREAM PLAY_MIDI; do
+    sed "s/^#define PLAYBACK PLAY_DMA/#define PLAYBACK $mode/" main.c > "$out/main_$mode.c"
+    gcc -fsyntax-only -Wall -Werror -D__ARM_ARCH=7 -I. "$out/main_$mode.c"
+done
+
+gcc -O2 -I. -o "$out/render" host/RENDER.c PWM.c TIMER.c SEQUENCER.c PACKED_SONG.c PITCHES.c DDS.c ENVELOPE.c PWM_DMA.c -lm
+
+render() {
+    "$out/render" "$@" || { echo "FAIL: render $*"; exit 1; }
+}
+
+for song in fur_elise minecraft one_note short_rest; do
+    for mode in hz regs packed dds dma; do
+        render $song $mode "$out/$song.wav" "$out/$song.json"
+    done
+    render $song packed "$out/$song.wav" "$out/$song.json" 0   # cut-short note changes (clicks allowed)
+done
+
+# Slow tempo: 26 / 256 stretches Minecraft's 400 ms notes past one 16-bit TIM15 period (~2.4 s),
+# which used to clamp them: 143.2 s instead of 162.5 s
+for mode in hz regs packed; do
+    render minecraft $mode "$out/minecraft_slow.wav" "$out/minecraft_slow.json" 1 26
+done
+
+# DDS mixer: cost per sample with every voice on, and the 4-voice chord demo must not clip
+gcc -O2 -I. -o "$out/dds_bench" host/DDS_BENCH.c DDS.c ENVELOPE.c POLY_SONG.c PWM.c PITCHES.c
+"$out/dds_bench" 200000 5 || { echo "FAIL: dds_bench"; exit 1; }
+
+# Pitch accuracy: fixed PSC_PWM against the per-note solver, note by note; every pitch within 0.05 cents
+gcc -O2 -I. -o "$out/pitch_report" host/PITCH_REPORT.c PITCHES.c -lm
+"$out/pitch_report" || { echo "FAIL: pitch_report"; exit 1; }
+
+# Song streaming: back-to-back songs, short and empty blocks, a late host; credits must balance
+gcc -O2 -I. -o "$out/stream_sim" host/STREAM_SIM.c SONG_STREAM.c PITCHES.c
+"$out/stream_sim" 30 || { echo "FAIL: stream_sim"; exit 1; }
+
+# MIDI synthesizer: note-to-PWM latency within one control tick (1000-cycle sample interrupt)
+gcc -O2 -I. -o "$out/midi_replay" host/MIDI_REPLAY.c MIDI.c DDS.c ENVELOPE.c PWM.c PITCHES.c
+"$out/midi_replay" 1000 || { echo "FAIL: midi_replay"; exit 1; }
+
+# Playback next to the lab6 request loop: same song lengths, responses as fast as with no song
+gcc -O2 -I. -o "$out/coop_sim" host/COOP_SIM.c SEQUENCER.c PWM.c TIMER.c PACKED_SONG.c PITCHES.c -lm
+"$out/coop_sim" || { echo "FAIL: coop_sim"; exit 1; }
+
+# midi2song: a format 0 file with running status, a tempo change and overlapping notes (the timeline
+# is in host/MIDI2SONG_CHECK.c), converted in every layout; the tables must compile and match
+bytes() {
+    for b in "$@"; do printf "\\$(printf %o "0x$b")"; done
+}
+{
+    bytes 4D 54 68 64  00 00 00 06  00 00  00 01  00 60   # MThd: format 0, 1 track, 96 ticks per quarter
+    bytes 4D 54 72 6B  00 00 00 2E                        # MTrk, 46 bytes
+    bytes 00 FF 51 03 07 A1 20                            # tempo 500000 us per quarter (120 bpm)
+    bytes 00 90 3C 64                                     # C4 on
+    bytes 30 40 64                                        # +48: E4 on, running status
+    bytes 30 3C 00                                        # +48: C4 off as velocity 0, running status
+    bytes 00 FF 51 03 0F 42 40                            # tempo 1000000 us per quarter (60 bpm)
+    bytes 30 80 40 40                                     # +48: E4 off
+    bytes 30 90 43 64                                     # +48: G4 on
+    bytes 18 45 64                                        # +24: A4 on, running status
+    bytes 18 43 00                                        # +24: G4 off
+    bytes 82 08 45 00                                     # +264: A4 off
+    bytes 00 FF 2F 00                                     # end of track
+} > "$out/fixture.mid"
+gcc -O2 -I. -o "$out/midi2song" host/MIDI2SONG.c PITCHES.c
+"$out/midi2song" -f list -n fixture -o "$out/fixture_list.h" "$out/fixture.mid"
+"$out/midi2song" -f hz -n fixture_hz -o "$out/fixture_hz.h" "$out/fixture.mid"
+"$out/midi2song" -f regs -n fixture_regs -o "$out/fixture_regs.h" "$out/fixture.mid"
+"$out/midi2song" -f hz -m lowest -n fixture_lowest -o "$out/fixture_lowest.h" "$out/fixture.mid"
+gcc -O2 -Wall -Werror -I. -I"$out" -o "$out/midi2song_check" host/MIDI2SONG_CHECK.c
+"$out/midi2song_check" || { echo "FAIL: midi2song_check"; exit 1; }
+
+echo "all checks passed"
@@ -22,154 +22,116 @@
 #include "STM32L432KC_GPIO.h"
 #include "TIMER.h"
 #include "PWM.h"
+#include "SEQUENCER.h"
+#include "PWM_DMA.h"
+#include "SONGS.h"
+#include "PACKED_SONG.h"
+#include "DDS.h"
+#include "POLY_SONG.h"
+#include "SONG_STREAM.h"
+#include "MIDI.h"
+
+// How the songs are played:
+//    PLAY_DMA    -> DMA bursts into TIM16 (PWM_DMA.c, no CPU per note)
+//    PLAY_REGS   -> TIM15 update interrupt writes compiled register values (SEQUENCER.c)
+//    PLAY_PACKED -> TIM15 update interrupt decodes 16-bit packed notes (SEQUENCER.c, PACKED_SONG.c)
+//    PLAY_DDS    -> 80 kHz carrier whose duty follows a sine wavetable (DDS.c), notes timed by delaying(),
+//                   followed by a 4-voice chord demo through the DDS mixer (POLY_SONG.c)
+//    PLAY_STREAM -> after the two songs, plays packed notes sent by the host over USART2 (SONG_STREAM.c)
+//    PLAY_MIDI   -> live synthesizer: MIDI note on/off over USART2 plays the DDS voices (MIDI.c)
+#define PLAY_DMA    0
+#define PLAY_REGS   1
+#define PLAY_PACKED 2
+#define PLAY_DDS    3
+#define PLAY_STREAM 4
+#define PLAY_MIDI   5
+#define PLAYBACK PLAY_DMA
+
+#define STREAM_TEMPO 25 // ms per time unit of streamed notes
+
+#define MIDI_SAMPLE_RATE 16000 // DDS rate in PLAY_MIDI: a note is heard within 75 us (host/MIDI_REPLAY.c)
+
+#define MAX_RECORDS 256 // compiled TIM16 records per song (long notes take several)
+pwm_record song_records[MAX_RECORDS];
+
+
+// Songs (SONGS.h) as pitch in Hz, duration in ms
+#define NOTE_HZ_MS(name, ms) {PITCH_HZ(name), ms},
+const int fur_elise_song[][2] = { FUR_ELISE_SONG(NOTE_HZ_MS) };
+const int minecraft_notes[][2] = { MINECRAFT_NOTES(NOTE_HZ_MS) };
+
+// Same songs compiled into TIM16 ARR/CCR1 and TIM15 reload values: no division at note boundaries,
+// and a note whose ARR or duration does not fit 16 bits fails the build here
+#define NOTE_REGS_OF(name, ms) NOTE_REGS(PITCH_HZ(name), ms)
+const note_regs fur_elise_regs[] = { FUR_ELISE_SONG(NOTE_REGS_OF) };
+const note_regs minecraft_regs[] = { MINECRAFT_NOTES(NOTE_REGS_OF) };
+
+// Same songs packed to 2 bytes per note (PACKED_SONG.h): 220 + 156 bytes instead of 880 + 624
+#define FUR_ELISE_PACKED(name, ms) NOTE_PACKED(name, ms, FUR_ELISE_TEMPO)
+#define MINECRAFT_PACKED(name, ms) NOTE_PACKED(name, ms, MINECRAFT_TEMPO)
+const uint16_t fur_elise_notes[] = { FUR_ELISE_SONG(FUR_ELISE_PACKED) };
+const uint16_t minecraft_packed_notes[] = { MINECRAFT_NOTES(MINECRAFT_PACKED) };
+const packed_song fur_elise_packed = { FUR_ELISE_TEMPO, sizeof(fur_elise_notes) / sizeof(fur_elise_notes[0]), fur_elise_notes };
+const packed_song minecraft_packed = { MINECRAFT_TEMPO, sizeof(minecraft_packed_notes) / sizeof(minecraft_packed_notes[0]), minecraft_packed_notes };
+
+// Polyphonic chord demo (SONGS.h): up to DDS_VOICES notes per step
+const poly_step chord_demo[] = { CHORD_DEMO(POLY_STEP) };
+const instrument chord_demo_voices[DDS_VOICES] = CHORD_DEMO_VOICES;
+
+// Live MIDI voices: plucked notes (ENVELOPE.h)
+const instrument midi_voices[DDS_VOICES] = { INSTRUMENT_PLUCK, INSTRUMENT_PLUCK, INSTRUMENT_PLUCK, INSTRUMENT_PLUCK };
+volatile uint32_t midi_isr_cycles = 0; // worst sample interrupt so far (DDS_max_cycles()), read it in the debugger
+
+#if PLAYBACK != PLAY_DDS
+// Player events (SEQUENCER.h) from the sequencer or the DMA player, handled in the main loop by player_poll()
+volatile uint32_t notes_played = 0; // read them in the debugger
+volatile uint32_t songs_played = 0;
+
+void on_player_event(const player_event * event) {
+    if (event->type == PLAYER_NOTE_DONE) notes_played++;
+    else songs_played++;
+}
 
+// Returns once the song is over; until then the CPU runs the player callback between interrupts and
+// sleeps when nothing is queued. Other firmware work would go in this loop, one short step per wakeup
+// (host/COOP_SIM.c measures it with the lab6 sensor/web loop as that step).
+void play_cooperatively(void) {
+    for (;;) {
+        int dma = song_dma_playing(); // read first: the DMA player posts PLAYER_SONG_DONE before clearing it
+        if (!player_poll() && !dma) return;
+        player_wait();
+    }
+}
+#endif
+
+#if PLAYBACK == PLAY_DDS
+// DDS per-sample cost at 8, 16 and 32 kHz: {sample rate, worst cycles, CPU load in per mille}.
+// Filled by dds_benchmark(); read it in the debugger.
+uint32_t dds_bench[3][3];
+
+// Plays A4 for 1 s at each sample rate and records the cost of the sample interrupt
+void dds_benchmark(void) {
+    const uint32_t rates[3] = {8000, 16000, 32000};
+    for (int i = 0; i < 3; i++) {
+        init_DDS(rates[i]);
+        DDS_frequency(440);
+        delaying(1000);
+        dds_bench[i][0] = rates[i];
+        dds_bench[i][1] = DDS_max_cycles();
+        dds_bench[i][2] = DDS_load();
+    }
+    DDS_frequency(0);
+}
 
-// Pitch in Hz, duration in ms
-const int fur_elise_song[][2] = {
-{659,	125},
-{623,	125},
-{659,	125},
-{623,	125},
-{659,	125},
-{494,	125},
-{587,	125},
-{523,	125},
-{440,	250},
-{  0,	125},
-{262,	125},
-{330,	125},
-{440,	125},
-{494,	250},
-{  0,	125},
-{330,	125},
-{416,	125},
-{494,	125},
-{523,	250},
-{  0,	125},
-{330,	125},
-{659,	125},
-{623,	125},
-{659,	125},
-{623,	125},
-{659,	125},
-{494,	125},
-{587,	125},
-{523,	125},
-{440,	250},
-{  0,	125},
-{262,	125},
-{330,	125},
-{440,	125},
-{494,	250},
-{  0,	125},
-{330,	125},
-{523,	125},
-{494,	125},
-{440,	250},
-{  0,	125},
-{494,	125},
-{523,	125},
-{587,	125},
-{659,	375},
-{392,	125},
-{699,	125},
-{659,	125},
-{587,	375},
-{349,	125},
-{659,	125},
-{587,	125},
-{523,	375},
-{330,	125},
-{587,	125},
-{523,	125},
-{494,	250},
-{  0,	125},
-{330,	125},
-{659,	125},
-{  0,	250},
-{659,	125},
-{1319,	125},
-{  0,	250},
-{623,	125},
-{659,	125},
-{  0,	250},
-{623,	125},
-{659,	125},
-{623,	125},
-{659,	125},
-{623,	125},
-{659,	125},
-{494,	125},
-{587,	125},
-{523,	125},
-{440,	250},
-{  0,	125},
-{262,	125},
-{330,	125},
-{440,	125},
-{494,	250},
-{  0,	125},
-{330,	125},
-{416,	125},
-{494,	125},
-{523,	250},
-{  0,	125},
-{330,	125},
-{659,	125},
-{623,	125},
-{659,	125},
-{623,	125},
-{659,	125},
-{494,	125},
-{587,	125},
-{523,	125},
-{440,	250},
-{  0,	125},
-{262,	125},
-{330,	125},
-{440,	125},
-{494,	250},
-{  0,	125},
-{330,	125},
-{523,	125},
-{494,	125},
-{440,	500},
-{  0,	500},
-{  0,	500}};
-
-
-// Minecraft "Sweden" by C418
-// Pitch in Hz, duration in ms (will be multiplied by 10x for proper tempo)
-// Target: Much slower, more accurate to original - very calm and peaceful
-const int minecraft_notes[][2] = {
-    // Main melody - very slow and peaceful (much longer base durations for 10x multiplier)
-    {349, 200}, {392, 200}, {330, 200}, {294, 200}, {330, 200}, {392, 200}, {523, 400},
-    {0, 100},
-    {349, 200}, {392, 200}, {330, 200}, {294, 200}, {330, 100}, {294, 100}, {262, 400},
-    {0, 200},
-    {349, 200}, {392, 200}, {330, 200}, {294, 200}, {330, 200}, {392, 200}, {523, 400},
-    {0, 100},
-    {587, 200}, {523, 200}, {494, 200}, {440, 200}, {494, 200}, {523, 400},
-    {0, 200},
-    
-    // Second part
-    {349, 200}, {392, 200}, {330, 200}, {294, 200}, {330, 200}, {392, 200}, {523, 400},
-    {0, 100},
-    {349, 200}, {392, 200}, {330, 200}, {294, 200}, {330, 100}, {294, 100}, {262, 400},
-    {0, 200},
-    
-    // Variation
-    {392, 200}, {440, 200}, {349, 200}, {330, 200}, {349, 200}, {440, 200}, {587, 400},
-    {0, 100},
-    {392, 200}, {440, 200}, {349, 200}, {330, 200}, {349, 100}, {330, 100}, {294, 400},
-    {0, 200},
-    
-    // Ending phrase
-    {349, 200}, {392, 200}, {330, 200}, {294, 200}, {330, 200}, {392, 200}, {523, 400},
-    {0, 100},
-    {587, 200}, {523, 200}, {494, 200}, {440, 200}, {494, 400}, {440, 400},
-    {0, 0}
-};
+// Plays a {Hz, ms} table through the DDS engine (busy-waits on TIM15 between notes)
+void play_song_DDS(const int (*song)[2], int len) {
+    for (int i = 0; i < len && song[i][1] != 0; i++) {
+        DDS_frequency(song[i][0]);
+        delaying(song[i][1]);
+    }
+    DDS_frequency(0);
+}
+#endif
 
 
 
@@ -204,37 +166,86 @@ int main(void) {
 
     // initialize our system:
       init_PWM(); // Initialize PWM generation system (function likely sets up TIM16 registers).
+      PWM_click_free(1); // Change notes at the end of a PWM period instead of cutting it short (no clicks)
       init_delaying(); // Initialize a delay system (uses TIM15 as a time base).
+#if PLAYBACK != PLAY_DDS
+      player_on_event(on_player_event); // note/song events from the sequencer or DMA player, see play_cooperatively()
+#endif
+
+
+#if PLAYBACK == PLAY_MIDI
+    // Everything happens in the USART2 and TIM6 interrupts
+    init_DDS(MIDI_SAMPLE_RATE);
+    init_MIDI(midi_voices);
+    while (1) {
+        __asm volatile ("wfi");
+        midi_isr_cycles = DDS_max_cycles(); // after playing, pass it to host/MIDI_REPLAY.c
+    }
+#endif
+
+    // Play both songs in the background: play_song() (SEQUENCER.c) returns immediately and the
+    // TIM15 update interrupt changes notes, so the CPU only wakes up once per note.
 
+    // With PLAY_DMA the song is first compiled into TIM16 register records that DMA1 writes by itself.
 
-    // Iterate through both arrays to play the music by setting the PWM frequency and having a delay to hold the signal:
+#if PLAYBACK == PLAY_DDS
+    // Measure the sample interrupt, then play the songs as sine tones at 16 kHz
+    dds_benchmark();
+    init_DDS(16000);
+    DDS_waveform(DDS_SINE);
+#endif
 
     // --- First song: Fur Elise ---
-    int i;
+#if PLAYBACK == PLAY_DDS
     int arr_length = sizeof(fur_elise_song) / sizeof(fur_elise_song[0]);
-    for (int i = 0; i < arr_length; i ++) {
-      if (fur_elise_song[i][1] == 0) {
-         PWM_frequency(0);
-        return 0;
-      }
-      // Set PWM to play the note's frequency
-       PWM_frequency(fur_elise_song[i][0]);
-      // Hold note for the given duration
-       delaying(fur_elise_song[i][1]);
-    }
+    play_song_DDS(fur_elise_song, arr_length);
+#elif PLAYBACK == PLAY_DMA
+    int arr_length = sizeof(fur_elise_song) / sizeof(fur_elise_song[0]);
+    play_song_dma(song_records, compile_song(fur_elise_song, arr_length, song_records, MAX_RECORDS));
+    play_cooperatively(); // asleep until the DMA player's end-of-song interrupts
+#elif PLAYBACK == PLAY_REGS
+    int arr_length = sizeof(fur_elise_regs) / sizeof(fur_elise_regs[0]);
+    play_song_regs(fur_elise_regs, arr_length);
+    play_cooperatively(); // sleep until the next interrupt when there is nothing else to do
+#else
+    play_song_packed(&fur_elise_packed);
+    play_cooperatively();
+#endif
 
 
     // --- Second song: Minecraft notes ---
+#if PLAYBACK == PLAY_DDS
     int arr_length2 = sizeof(minecraft_notes) / sizeof(minecraft_notes[0]);
-    for (int i = 0; i < arr_length2; i ++) {
-      if (minecraft_notes[i][1] == 0) {
-         PWM_frequency(0);
-        return 0;
-      }
-       PWM_frequency(minecraft_notes[i][0]);
-      delaying(minecraft_notes[i][1]);
+    play_song_DDS(minecraft_notes, arr_length2);
+
+    // --- Chords: four voices with ADSR envelopes mixed into one PWM duty ---
+    play_poly_song(chord_demo, sizeof(chord_demo) / sizeof(chord_demo[0]), chord_demo_voices);
+    stop_DDS();
+#elif PLAYBACK == PLAY_DMA
+    int arr_length2 = sizeof(minecraft_notes) / sizeof(minecraft_notes[0]);
+    play_song_dma(song_records, compile_song(minecraft_notes, arr_length2, song_records, MAX_RECORDS));
+    play_cooperatively();
+#elif PLAYBACK == PLAY_REGS
+    int arr_length2 = sizeof(minecraft_regs) / sizeof(minecraft_regs[0]);
+    play_song_regs(minecraft_regs, arr_length2);
+    play_cooperatively();
+#else
+    play_song_packed(&minecraft_packed);
+    play_cooperatively();
+#endif
+
+#if PLAYBACK == PLAY_STREAM
+    // --- Streamed songs: any length, only the 256-byte ping-pong buffer in RAM ---
+    // The host waits for a credit byte before each block of notes, so it can never overrun us.
+    init_stream();
+    while (1) {
+        stream_start(STREAM_TEMPO);
+        play_song_source(stream_next);
+        play_cooperatively();
     }
-	
+#endif
+
+    return 0;
 }
 
 /*************************** End of file ****************************/
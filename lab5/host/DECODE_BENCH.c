@@ -0,0 +1,135 @@
+// DECODE_BENCH.c
+// Marina Bellido: mbellido@g.hmc.edu
+// Host microbenchmark of the per-edge decode step: the table-driven encoderUpdate() (lib/ENCODER.c,
+// one quadTable load and one add) against the original if/else chain, checkDirection() plus the
+// counter++ of lab5's first EXTI handler (copied below unchanged, volatile globals and all).
+// Both decode the same random edge stream (reversals, and now and then a glitch that leaves the pins
+// unchanged) and must agree on every direction; each is timed over the whole stream, best of several
+// runs, and reported in ns per edge.
+// These are host nanoseconds, not M4 cycles: the ratio is what carries over. On the board, the
+// PROFILE_EXTI histogram (PROFILE.c) gives the handler's cycles.
+//
+// Build and run from lab5:
+//    gcc -O2 -Ihost -Ilib -o decode_bench host/DECODE_BENCH.c host/SIM_REGS.c lib/ENCODER.c lib/EDGE_QUEUE.c lib/PROFILE.c lib/FORMAT.c lib/STM32L432KC_GPIO.c
+//    ./decode_bench
+//
+// Usage: decode_bench [edges] [runs] [seed]
+//    -- edges: length of the edge stream, 1000000 by default
+//    -- runs: timed runs per decoder (the best one is reported), 20 by default
+//    -- seed: random stream seed
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "STM32L432KC.h"
+#include "ENCODER.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define CW 0
+#define CCW 1
+
+static const uint8_t cwStates[4] = { QUAD_STATE(0, 0), QUAD_STATE(1, 0), QUAD_STATE(1, 1), QUAD_STATE(0, 1) };
+
+///////////////////////////////////////////////////////////////////////////////
+// Original decoder (lab5 main.c before the table-driven decoder), unchanged
+///////////////////////////////////////////////////////////////////////////////
+
+volatile int counter = 0;
+volatile double direction = 0;
+volatile bool pastAstate = 0, pastBstate = 0;
+
+    void checkDirection(bool newAstate, bool newBstate){
+    // Quadrature encoder logic has 4 states: (A,B) = 00, 01, 10, 11. Check all 4 previous states
+    if (!pastAstate && !pastBstate) {
+        if (newAstate && !newBstate) direction = CW;
+         else if (!newAstate && newBstate) direction = CCW;
+    }
+    else if (!pastAstate && pastBstate) {
+        if (!newAstate && !newBstate) direction = CW;
+         else if (newAstate && newBstate) direction = CCW;
+    }
+    else if (pastAstate && !pastBstate) {
+        if (newAstate && newBstate) direction = CW;
+         else if (!newAstate && !newBstate) direction = CCW;
+    }
+    else if (pastAstate && pastBstate) {
+        if (!newAstate && newBstate) direction = CW;
+         else if (newAstate && !newBstate) direction = CCW;
+    }
+    pastAstate = newAstate;
+    pastBstate = newBstate;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Benchmark
+///////////////////////////////////////////////////////////////////////////////
+
+static uint64_t nowNs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// The old handler's work for one edge: count it and decide the direction
+static void oldDecode(const uint8_t * states, int n) {
+  for (int i = 0; i < n; i++) {
+    counter++;
+    checkDirection(states[i] >> 1, states[i] & 1);
+  }
+}
+
+static void newDecode(int id, const uint8_t * states, int n) {
+  for (int i = 0; i < n; i++) encoderUpdate(id, states[i]);
+}
+
+int main(int argc, char ** argv) {
+  int n = argc > 1 ? atoi(argv[1]) : 1000000;
+  int runs = argc > 2 ? atoi(argv[2]) : 20;
+  srand(argc > 3 ? atoi(argv[3]) : 1);
+
+  uint8_t * states = malloc(n);
+  if (!states) return 1;
+  int phase = 0, dir = 1;
+  for (int i = 0; i < n; i++) {
+    if (rand() % 256 == 0) dir = -dir;
+    if (rand() % 64 != 0) phase = (phase + dir + 4) & 3; // else: a glitch, the pins read unchanged
+    states[i] = cwStates[phase];
+  }
+
+  sim_GPIOA.IDR = 0; // both pins low: the state the stream starts from
+  int id = encoderRegister(PA6, PA8);
+
+  // Same decisions: the old direction after each edge matches the sign of the new position step
+  uint32_t mismatches = 0;
+  for (int i = 0; i < n; i++) {
+    int32_t before = encoderPosition(id);
+    encoderUpdate(id, states[i]);
+    checkDirection(states[i] >> 1, states[i] & 1);
+    int32_t step = encoderPosition(id) - before;
+    if (step && (step > 0) != (direction == CW)) mismatches++;
+  }
+
+  uint64_t oldBest = UINT64_MAX, newBest = UINT64_MAX;
+  for (int r = 0; r < runs; r++) {
+    uint64_t t0 = nowNs();
+    oldDecode(states, n);
+    uint64_t t1 = nowNs();
+    encoderReset(id);
+    newDecode(id, states, n);
+    uint64_t t2 = nowNs();
+    if (t1 - t0 < oldBest) oldBest = t1 - t0;
+    if (t2 - t1 < newBest) newBest = t2 - t1;
+  }
+
+  printf("%d edges, best of %d runs\n", n, runs);
+  printf("if/else chain (checkDirection + counter): %6.2f ns/edge\n", (double)oldBest / n);
+  printf("quadTable (encoderUpdate):                %6.2f ns/edge (%.1fx)\n", (double)newBest / n,
+         (double)oldBest / newBest);
+  printf("direction mismatches: %u %s\n", mismatches, mismatches ? "FAIL" : "ok");
+  return mismatches ? 1 : 0;
+}
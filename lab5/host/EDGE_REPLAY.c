@@ -0,0 +1,191 @@
+// EDGE_REPLAY.c
+// Marina Bellido: mbellido@g.hmc.edu
+// Host edge replay of the EXTI decoding path. Links the real ENCODER.c (encoderEXTIHandler(), the edge
+// queue, encoderProcess()) against the host register model and replays a quadrature signal on PA6/PA8
+// in 80 MHz core cycles, with the interrupt timing of the board:
+//    -- an edge sets its EXTI pending bit; the handler is entered ENTRY_CYCLES after the first pending
+//       edge (or after the previous handler returns), latches PR1 and samples IDR SAMPLE_CYCLES later
+//    -- edges up to that sample are seen together: two edges read as an illegal transition, an edge
+//       and its undo as a double; edges after it stay pending and re-enter the handler
+//    -- the handler body costs handler_cycles, then EXIT_CYCLES before the next entry
+// The edge interval is jittered by +-jitter to model A/B phase and duty error, and the shaft reverses
+// now and then. Each rate reports the illegal transitions, the samples no decoder can recover (three
+// edges or more, or a pair against the direction of the last single edge seen), the counts miscounted in all other samples (lost)
+// and the final position error against the true edge count. Rates: the encoder's full speed
+// (SPEED_MAX_EDGES), then edges as fast as the handler itself, where pairs start to collapse.
+// Build once per ENCODER_RECOVER_ILLEGAL setting to compare them:
+//    -- 0 (default): loses exactly 2 counts per illegal transition, so it is only lossless where no pair collapses
+//    -- 1: must lose nothing outside the unrecoverable samples
+// Both must be lossless at full speed.
+//
+// Build and run from lab5:
+//    gcc -O2 -Ihost -Ilib -o edge_replay host/EDGE_REPLAY.c host/SIM_REGS.c lib/ENCODER.c lib/EDGE_QUEUE.c lib/PROFILE.c lib/FORMAT.c lib/STM32L432KC_GPIO.c
+//    ./edge_replay <handler_cycles>
+// (add -DENCODER_RECOVER_ILLEGAL=1 for the recovering decoder)
+//
+// Usage: edge_replay <handler_cycles> [edges] [jitter_pct] [seed]
+//    -- handler_cycles: EXTI handler body in cycles, the PROFILE_EXTI max= of the board's profile dump
+//    -- edges: edges replayed per rate, 1000000 by default
+//    -- jitter_pct: edge interval spread in percent, 50 by default
+//    -- seed: random signal seed
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "STM32L432KC.h"
+#include "ENCODER.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define CORE_HZ 80000000ULL
+#define ENTRY_CYCLES 12        // exception entry (stacking) before the first instruction
+#define EXIT_CYCLES 12         // exception return
+#define SAMPLE_CYCLES 4        // first instruction to the PR1/IDR loads (CYCCNT stamp, PR1 load)
+#define SPEED_MAX_EDGES 100000 // encoder full speed in edges/s (main.h: well under 100 kedges/s)
+#define REVERSE_ONE_IN 4096    // edges between direction changes, on average
+#define LINE_A 6               // PA6
+#define LINE_B 8               // PA8
+
+static const uint8_t cwStates[4] = { QUAD_STATE(0, 0), QUAD_STATE(1, 0), QUAD_STATE(1, 1), QUAD_STATE(0, 1) };
+
+// Outcome of one replay
+typedef struct {
+  uint64_t entries;       // handler entries
+  int32_t  error;         // decoded position - true position at the end
+  uint32_t illegal;       // illegal transitions the decoder saw
+  uint32_t doubles;       // edge + undo seen as no change
+  uint32_t unrecoverable; // samples with 3+ edges, or a pair against the last single edge seen
+  uint32_t lost;          // counts miscounted in the other samples (each sample's |error change|)
+  uint32_t lostIllegal;   // illegal transitions in the other samples
+  uint32_t dropped;       // edge records lost to a full queue
+} replayResult;
+
+///////////////////////////////////////////////////////////////////////////////
+// Replay
+///////////////////////////////////////////////////////////////////////////////
+
+static replayResult replay(int id, double interval, double jitter, int edges, uint64_t handlerCycles) {
+  replayResult r = {0, 0, 0, 0, 0, 0, 0, 0};
+  encoderStats before, after;
+  sim_GPIOA.IDR = 0;
+  encoderReset(id);
+  encoderReadStats(id, &before);
+  uint32_t droppedBefore = encoderDropped();
+
+  int phase = 0, dir = 1;
+  int seenDir = 0;           // direction of the last single edge the handler saw (the decoder's lastStep)
+  uint8_t seenState = cwStates[0];
+  int32_t truth = 0, lastError = 0;
+  uint32_t lastIllegal = before.illegal;
+  double nextEdge = interval;
+  uint64_t cpuFree = 0;
+  uint32_t pending = 0;
+  uint64_t firstPending = 0;
+  int k = 0, kDirs = 0, kFirstDir = 0; // edges since the last sample: count, net direction, first one
+
+  for (int i = 0; i < edges || pending; ) {
+    // Idle until an edge sets a pending bit
+    if (!pending) {
+      if (i >= edges) break;
+      firstPending = (uint64_t)nextEdge;
+    }
+    uint64_t entry = (firstPending > cpuFree ? firstPending : cpuFree) + ENTRY_CYCLES;
+    uint64_t sample = entry + SAMPLE_CYCLES;
+
+    // Every edge up to the sample is in PR1 and in the pin levels the handler reads
+    while (i < edges && (uint64_t)nextEdge <= sample) {
+      if (rand() % REVERSE_ONE_IN == 0) dir = -dir;
+      uint8_t old = cwStates[phase];
+      phase = (phase + dir + 4) & 3;
+      uint8_t moved = old ^ cwStates[phase];
+      pending |= (moved & 0b10) ? (1 << LINE_A) : (1 << LINE_B);
+      truth += dir;
+      if (k == 0) kFirstDir = dir;
+      k++;
+      kDirs += dir;
+      i++;
+      double spread = 1.0 + jitter * (2.0 * rand() / RAND_MAX - 1.0);
+      nextEdge += interval * spread;
+    }
+
+    uint8_t state = cwStates[phase];
+    sim_GPIOA.IDR = ((uint32_t)(state >> 1) << LINE_A) | ((uint32_t)(state & 1) << LINE_B);
+    sim_EXTI.PR1 = pending;
+    encoderEXTIHandler();
+    pending &= ~sim_EXTI.PR1; // write-1-to-clear of what the handler wrote
+    encoderProcess();         // the sampler ISR drains the queue; its timing does not matter here
+    r.entries++;
+
+    // Classify what this sample saw; a recoverable one must decode exactly or lose 2 per illegal transition
+    encoderReadStats(id, &after);
+    int32_t error = encoderPosition(id) - truth;
+    if (k >= 3 || (k == 2 && kDirs != 0 && kFirstDir != seenDir)) {
+      r.unrecoverable++;
+    } else {
+      r.lost += abs(error - lastError);
+      r.lostIllegal += after.illegal - lastIllegal;
+    }
+    lastError = error;
+    lastIllegal = after.illegal;
+    int8_t seen = quadDecode(seenState, state);
+    if (seen == QUAD_CW || seen == QUAD_CCW) seenDir = seen;
+    seenState = state;
+    k = 0;
+    kDirs = 0;
+
+    cpuFree = entry + handlerCycles + EXIT_CYCLES;
+    if (pending) firstPending = sample;
+  }
+
+  encoderReadStats(id, &after);
+  r.error = encoderPosition(id) - truth;
+  r.illegal = after.illegal - before.illegal;
+  r.doubles = after.doubles - before.doubles;
+  r.dropped = encoderDropped() - droppedBefore;
+  return r;
+}
+
+int main(int argc, char ** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: edge_replay <handler_cycles> [edges] [jitter_pct] [seed]\n"
+                    "   handler_cycles: PROFILE_EXTI max= from the board's profile dump\n");
+    return 2;
+  }
+  uint64_t handlerCycles = (uint64_t)atoi(argv[1]);
+  int edges = argc > 2 ? atoi(argv[2]) : 1000000;
+  double jitter = (argc > 3 ? atoi(argv[3]) : 50) / 100.0;
+  srand(argc > 4 ? atoi(argv[4]) : 1);
+
+  sim_GPIOA.IDR = 0;
+  int id = encoderRegister(PA6, PA8);
+  uint64_t busy = ENTRY_CYCLES + handlerCycles + EXIT_CYCLES; // one handler entry, start to finish
+
+  // Full speed, then edges every 4, 2, 1.5, 1 and 0.75 handler entries
+  const double perEntry[] = { 0, 4, 2, 1.5, 1, 0.75 };
+  int fails = 0;
+
+  printf("ENCODER_RECOVER_ILLEGAL %d, handler %llu cycles (%llu per entry), jitter +-%.0f%%, %d edges per rate\n",
+         ENCODER_RECOVER_ILLEGAL, (unsigned long long)handlerCycles, (unsigned long long)busy, jitter * 100, edges);
+  printf("%10s %9s %9s %9s %9s %9s %13s\n", "edges/s", "entries", "illegal", "doubles", "lost", "error", "unrecoverable");
+  for (int row = 0; row < (int)(sizeof(perEntry) / sizeof(perEntry[0])); row++) {
+    double interval = perEntry[row] ? perEntry[row] * busy : (double)CORE_HZ / SPEED_MAX_EDGES;
+    replayResult r = replay(id, interval, jitter, edges, handlerCycles);
+
+    // Full speed must be lossless. Outside the unrecoverable samples, recovery must lose nothing and
+    // rejection exactly 2 counts per illegal transition.
+    int ok = !r.dropped && (ENCODER_RECOVER_ILLEGAL ? r.lost == 0 : r.lost == 2 * r.lostIllegal);
+    if (perEntry[row] == 0) ok = ok && r.error == 0 && r.unrecoverable == 0;
+    fails += !ok;
+
+    printf("%10.0f %9llu %9u %9u %9u %9d %13u %7s%s\n", CORE_HZ / interval, (unsigned long long)r.entries,
+           r.illegal, r.doubles, r.lost, r.error, r.unrecoverable, ok ? "ok" : "FAIL",
+           perEntry[row] == 0 ? "  (full speed)" : "");
+    if (r.dropped) printf("%10s %u edge records dropped: queue full\n", "", r.dropped);
+  }
+  printf("%s\n", fails ? "FAIL" : (ENCODER_RECOVER_ILLEGAL ?
+         "ok: lossless except in unrecoverable samples" :
+         "ok: lossless only while no pair collapses, 2 counts lost per illegal transition"));
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,158 @@
+// ENCODER_TIM_CHECK.c
+// Marina Bellido: mbellido@g.hmc.edu
+// Host check of ENCODER_MODE_TIM against the original EXTI decoder. Runs the real initEncoderTIM()
+// (lib/STM32L432KC_TIM.c) on the host register model, then plays a random quadrature signal into a
+// model of the TIM1 encoder interface as that configuration sets it up (RM0394 "Counting direction
+// versus encoder signals": CC1S/CC2S, CC1P/CC2P, SMS, PSC, ARR) and, edge by edge, into the
+// original checkDirection() from lab5's first main.c (copied below unchanged, one edge per interrupt
+// as on the board). Checked:
+//    -- every edge moves CNT by one step in the direction checkDirection() decided
+//    -- every window's signed CNT difference equals checkDirection()'s net count, and windows without a
+//       reversal have |difference| == the old edge counter
+// Wiring as in main.h: TIM1_CH1 = PA8 = channel B, TIM1_CH2 = PA9 = channel A (jumpered from PA6).
+//
+// Build and run from lab5:
+//    gcc -O2 -Ihost -Ilib -Isrc -o encoder_tim_check host/ENCODER_TIM_CHECK.c host/SIM_REGS.c lib/STM32L432KC_TIM.c
+//    ./encoder_tim_check
+//
+// Usage: encoder_tim_check [windows] [seed]
+//    -- windows: sample windows to replay, 10000 by default
+//    -- seed: random signal seed
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "STM32L432KC_TIM.h"
+#include "main.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define CW 0
+#define CCW 1
+
+// CW sequence of (A, B): 00 -> 10 -> 11 -> 01 -> 00 (A leads B)
+static const uint8_t cwA[4] = { 0, 1, 1, 0 };
+static const uint8_t cwB[4] = { 0, 0, 1, 1 };
+
+///////////////////////////////////////////////////////////////////////////////
+// Original decoder (lab5 main.c before the table-driven decoder), unchanged
+///////////////////////////////////////////////////////////////////////////////
+
+volatile double direction = 0;
+volatile bool pastAstate = 0, pastBstate = 0;
+
+    void checkDirection(bool newAstate, bool newBstate){
+    // Quadrature encoder logic has 4 states: (A,B) = 00, 01, 10, 11. Check all 4 previous states
+    if (!pastAstate && !pastBstate) {
+        if (newAstate && !newBstate) direction = CW;
+         else if (!newAstate && newBstate) direction = CCW;
+    }
+    else if (!pastAstate && pastBstate) {
+        if (!newAstate && !newBstate) direction = CW;
+         else if (newAstate && newBstate) direction = CCW;
+    }
+    else if (pastAstate && !pastBstate) {
+        if (newAstate && newBstate) direction = CW;
+         else if (!newAstate && !newBstate) direction = CCW;
+    }
+    else if (pastAstate && pastBstate) {
+        if (!newAstate && newBstate) direction = CW;
+         else if (newAstate && !newBstate) direction = CCW;
+    }
+    pastAstate = newAstate;
+    pastBstate = newBstate;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// TIM encoder interface model
+///////////////////////////////////////////////////////////////////////////////
+
+// Input levels after the channel polarity (TI1FP1, TI2FP2)
+static int ti1(TIM_TypeDef * TIMx, int ch1) { return ch1 ^ ((TIMx->CCER & TIM_CCER_CC1P) != 0); }
+static int ti2(TIM_TypeDef * TIMx, int ch2) { return ch2 ^ ((TIMx->CCER & TIM_CCER_CC2P) != 0); }
+
+// Returns 0 if the registers describe the encoder interface this model covers
+static const char * checkConfig(TIM_TypeDef * TIMx) {
+  if (!(TIMx->CR1 & TIM_CR1_CEN)) return "counter not enabled";
+  if ((TIMx->SMCR & TIM_SMCR_SMS) != 0b011) return "not encoder mode 3 (SMS != 011)";
+  if (_VAL2FLD(TIM_CCMR1_CC1S, 1) != (TIMx->CCMR1 & TIM_CCMR1_CC1S)) return "IC1 not mapped on TI1";
+  if (_VAL2FLD(TIM_CCMR1_CC2S, 1) != (TIMx->CCMR1 & TIM_CCMR1_CC2S)) return "IC2 not mapped on TI2";
+  if (TIMx->CCER & (TIM_CCER_CC1NP | TIM_CCER_CC2NP)) return "CCxNP set in encoder mode";
+  if (TIMx->PSC != 0) return "prescaler drops edges";
+  if (TIMx->ARR != 0xFFFF) return "counter does not wrap over 16 bits";
+  return 0;
+}
+
+// One input edge in encoder mode 3: the channel that moved counts, the other one's level sets the direction
+static void timEdge(TIM_TypeDef * TIMx, int ch1, int ch2, int ch1Moved) {
+  int up;
+  if (ch1Moved) {
+    int rising = ti1(TIMx, ch1);
+    up = ti2(TIMx, ch2) ? !rising : rising;  // TI2FP2 high: rising counts down
+  } else {
+    int rising = ti2(TIMx, ch2);
+    up = ti1(TIMx, ch1) ? rising : !rising;  // TI1FP1 high: rising counts up
+  }
+  TIMx->CNT = (TIMx->CNT + (up ? 1 : TIMx->ARR)) % (TIMx->ARR + 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Replay
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char ** argv) {
+  int windows = argc > 1 ? atoi(argv[1]) : 10000;
+  srand(argc > 2 ? atoi(argv[2]) : 1);
+
+  initEncoderTIM(ENCODER_TIM, 1, ENCODER_FILTER); // as main.c in ENCODER_MODE_TIM
+  const char * bad = checkConfig(ENCODER_TIM);
+  if (bad) {
+    printf("FAIL: TIM1 configuration: %s\n", bad);
+    return 1;
+  }
+
+  int phase = 0;                 // position in the CW sequence
+  int dir = 1;                   // +1 CW, -1 CCW
+  uint16_t lastCount = readEncoderTIM(ENCODER_TIM);
+  uint32_t edges = 0, edgeFails = 0, windowFails = 0, reversalWindows = 0;
+
+  for (int w = 0; w < windows; w++) {
+    int n = rand() % 600;        // 0 .. 599 edges per 10 ms window: stopped to ~37 rotations/s
+    int counter = 0, net = 0, reversed = 0;
+
+    for (int i = 0; i < n; i++) {
+      if (rand() % 2048 == 0) { dir = -dir; reversed = 1; }
+      phase = (phase + dir + 4) & 3;
+      int a = cwA[phase], b = cwB[phase];
+      int bMoved = (b != pastBstate);
+
+      uint16_t before = readEncoderTIM(ENCODER_TIM);
+      timEdge(ENCODER_TIM, b, a, bMoved); // CH1 = B, CH2 = A
+      int16_t step = (int16_t)(readEncoderTIM(ENCODER_TIM) - before);
+
+      // The original ISR: one edge, count it, decide the direction
+      counter++;
+      checkDirection(a, b);
+      int oldStep = (direction == CW) ? 1 : -1;
+      net += oldStep;
+
+      edges++;
+      if (step != oldStep) edgeFails++;
+    }
+
+    uint16_t count = readEncoderTIM(ENCODER_TIM);
+    int16_t counts = (int16_t)(count - lastCount);
+    lastCount = count;
+    reversalWindows += reversed;
+    if (counts != net || (!reversed && abs(counts) != counter)) windowFails++;
+  }
+
+  printf("%d windows, %u edges (%u windows with a reversal)\n", windows, edges, reversalWindows);
+  printf("edges where CNT disagrees with checkDirection(): %u\n", edgeFails);
+  printf("windows where the count disagrees: %u\n", windowFails);
+  printf("%s\n", (edgeFails || windowFails) ? "FAIL" : "ok: TIM1 encoder mode counts as checkDirection() decides");
+  return (edgeFails || windowFails) ? 1 : 0;
+}
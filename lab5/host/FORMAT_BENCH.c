@@ -0,0 +1,114 @@
+// FORMAT_BENCH.c
+// Marina Bellido: mbellido@g.hmc.edu
+// Host microbenchmark of the telemetry line: speedEstimate() (lib/SPEED.c, integer milli-rotations/s)
+// formatted with lib/FORMAT.c, against the original float path of lab5's first main.c,
+//    speed = (float)counter/1632;  printf("\nCurrent speed: %.3f rotations/s", speed);  printf(" : CW direction");
+// with snprintf() standing in for printf() so both only build the line (the output itself costs the
+// same either way). Both turn the same random 1 s edge counts into a line; the speeds they print must
+// agree to 0.001 rotations/s (the float path rounds, the integer one truncates). Each is timed over
+// all counts, best of several runs, in ns per line.
+// These are host nanoseconds, not M4 cycles: the M4 has no double-precision FPU and printf's float
+// conversion runs in software there, so the gap on the board is wider than here.
+// host/size.sh gives the code size of both paths.
+//
+// Build and run from lab5:
+//    gcc -O2 -Ilib -o format_bench host/FORMAT_BENCH.c lib/FORMAT.c lib/SPEED.c
+//    ./format_bench
+//
+// Usage: format_bench [lines] [runs] [seed]
+//    -- lines: speed lines per run, 100000 by default
+//    -- runs: timed runs per path (the best one is reported), 20 by default
+//    -- seed: random count seed
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "FORMAT.h"
+#include "SPEED.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define LINE_LEN 128
+#define MAX_COUNTS (40 * COUNTS_PER_REV) // 1 s counts up to 40 rotations/s
+
+static volatile char sink; // keeps the compiler from dropping the lines
+
+///////////////////////////////////////////////////////////////////////////////
+// The two paths
+///////////////////////////////////////////////////////////////////////////////
+
+// Original: float division and printf's %.3f
+static int oldLine(char * line, int counter) {
+  float speed = (float)counter/1632; // 408*4
+  int n = snprintf(line, LINE_LEN, "\nCurrent speed: %.3f rotations/s", speed);
+  if (speed != 0.0) n += snprintf(line + n, LINE_LEN - n, " : CW direction");
+  return n;
+}
+
+// Now: integer estimate and FORMAT.c
+static int newLine(char * line, int counter) {
+  int method;
+  uint32_t speed = speedEstimate(counter, 0, 1000, &method);
+  char * p = line;
+  p = formatString(p, "\nCurrent speed: ");
+  p = formatMilli(p, speed);
+  p = formatString(p, " rotations/s");
+  if (speed != 0) p = formatString(p, " : CW direction");
+  *p = 0;
+  return p - line;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Benchmark
+///////////////////////////////////////////////////////////////////////////////
+
+static uint64_t nowNs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+int main(int argc, char ** argv) {
+  int lines = argc > 1 ? atoi(argv[1]) : 100000;
+  int runs = argc > 2 ? atoi(argv[2]) : 20;
+  srand(argc > 3 ? atoi(argv[3]) : 1);
+
+  int * counts = malloc(lines * sizeof(int));
+  if (!counts) return 1;
+  for (int i = 0; i < lines; i++) counts[i] = (i % 16 == 0) ? 0 : rand() % MAX_COUNTS;
+
+  // Same speeds, to the last digit the integer path keeps
+  char a[LINE_LEN], b[LINE_LEN];
+  uint32_t mismatches = 0;
+  for (int i = 0; i < lines; i++) {
+    oldLine(a, counts[i]);
+    newLine(b, counts[i]);
+    double oldSpeed = 0, newSpeed = 0;
+    sscanf(a, "\nCurrent speed: %lf", &oldSpeed);
+    sscanf(b, "\nCurrent speed: %lf", &newSpeed);
+    if (oldSpeed - newSpeed > 0.0015 || newSpeed - oldSpeed > 0.0005) {
+      if (mismatches++ < 3) printf("mismatch at %d counts:%s |%s\n", counts[i], a, b);
+    }
+  }
+
+  uint64_t oldBest = UINT64_MAX, newBest = UINT64_MAX;
+  for (int r = 0; r < runs; r++) {
+    uint64_t t0 = nowNs();
+    for (int i = 0; i < lines; i++) sink = a[oldLine(a, counts[i]) - 1];
+    uint64_t t1 = nowNs();
+    for (int i = 0; i < lines; i++) sink = b[newLine(b, counts[i]) - 1];
+    uint64_t t2 = nowNs();
+    if (t1 - t0 < oldBest) oldBest = t1 - t0;
+    if (t2 - t1 < newBest) newBest = t2 - t1;
+  }
+
+  printf("%d lines, best of %d runs\n", lines, runs);
+  printf("float + snprintf(%%.3f):        %7.1f ns/line\n", (double)oldBest / lines);
+  printf("speedEstimate + FORMAT.c:      %7.1f ns/line (%.1fx)\n", (double)newBest / lines,
+         (double)oldBest / newBest);
+  printf("speeds differing by more than 0.001: %u %s\n", mismatches, mismatches ? "FAIL" : "ok");
+  return mismatches ? 1 : 0;
+}
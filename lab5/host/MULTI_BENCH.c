@@ -0,0 +1,258 @@
+// MULTI_BENCH.c
+// Marina Bellido: mbellido@g.hmc.edu
+// Host benchmark of ENCODER_MAX encoders turning at once through the shared EXTI handler. Links the
+// real ENCODER.c against the host register model, registers four encoders on three EXTI vectors and
+// replays their signals together in 80 MHz core cycles (timing model of host/EDGE_REPLAY.c):
+//    enc 0: PA6/PA8   (EXTI9_5)      enc 2: PB4/PB5   (EXTI4, EXTI9_5)
+//    enc 1: PA0/PA1   (EXTI0, EXTI1) enc 3: PA10/PA11 (EXTI15_10)
+// plus PA7, another driver's pin on EXTI9_5 toggling at FOREIGN_HZ, whose line the handler must clear
+// and hand to encoderOnOtherEXTI() instead of re-entering forever.
+// The sampler drains the edge queue once per SPEED_WINDOW_MS window, as TIM6_DAC_IRQHandler() does.
+// An entry costs the measured handler_cycles for one moving encoder, scaled for more by the host time
+// of encoderEXTIHandler() with 1..4 records. For each speed (every encoder at that speed, each with
+// its own jitter, the four out of phase) it reports:
+//    -- EXTI CPU load, handler entries, entries shared by several encoders
+//    -- edge records dropped because the queue was full (EDGE_QUEUE_LEN per window)
+//    -- counts lost (every window's |position error| change, all encoders) and foreign edges delivered
+// Speeds up to SPEED_DESIGN rotations/s must lose no count and deliver every foreign edge; faster ones
+// are reported only. No speed may enter the handler more often than edges arrive.
+//
+// Build and run from lab5:
+//    gcc -O2 -Ihost -Ilib -Isrc -o multi_bench host/MULTI_BENCH.c host/SIM_REGS.c lib/ENCODER.c lib/EDGE_QUEUE.c lib/PROFILE.c lib/FORMAT.c lib/STM32L432KC_GPIO.c
+//    ./multi_bench <handler_cycles>
+//
+// Usage: multi_bench <handler_cycles> [seconds] [seed]
+//    -- handler_cycles: EXTI handler body in cycles, the PROFILE_EXTI max= of the board's profile dump
+//    -- seconds: simulated time per speed, 2 by default
+//    -- seed: random signal seed
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "STM32L432KC.h"
+#include "ENCODER.h"
+#include "SPEED.h"
+#include "main.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define CORE_HZ 80000000ULL
+#define ENTRY_CYCLES 12   // exception entry (stacking) before the first instruction
+#define EXIT_CYCLES 12    // exception return
+#define SAMPLE_CYCLES 4   // first instruction to the PR1/IDR loads
+#define WINDOW_CYCLES (CORE_HZ / 1000 * SPEED_WINDOW_MS)
+#define JITTER 0.5        // edge interval spread, +-50%
+#define SPEED_DESIGN 15   // rotations/s every encoder must sustain without losing a count
+#define FOREIGN_LINE 7    // PA7
+#define FOREIGN_HZ 1000   // toggles per second of the foreign pin
+#define ENCODERS 4
+
+static const int pinsA[ENCODERS] = { PA6, PA0, PB4, PA10 };
+static const int pinsB[ENCODERS] = { PA8, PA1, PB5, PA11 };
+static const uint8_t cwStates[4] = { QUAD_STATE(0, 0), QUAD_STATE(1, 0), QUAD_STATE(1, 1), QUAD_STATE(0, 1) };
+
+// One simulated encoder
+typedef struct {
+  int id;
+  double nextEdge;  // cycle of its next edge
+  int phase;        // position in the CW sequence
+  int32_t truth;    // true signed edge count
+  int32_t lastError;
+} simEncoder;
+
+static simEncoder enc[ENCODERS];
+static uint32_t foreignDelivered = 0;
+
+// Outcome of one speed
+typedef struct {
+  uint64_t entries, sharedEntries, busyCycles;
+  uint32_t dropped, lost, foreignEdges;
+  int storm;        // more entries than edges: a pending line re-entered the handler
+} benchResult;
+
+static void onForeign(uint32_t lines) {
+  if (lines & (1 << FOREIGN_LINE)) foreignDelivered++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Handler cost
+///////////////////////////////////////////////////////////////////////////////
+
+static uint64_t nowNs(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// Host time of one handler entry with n encoders moving, best of several runs (queue drained as it goes)
+static double handlerNs(int n) {
+  double best = 1e30;
+  uint32_t lines = 0;
+  for (int e = 0; e < n; e++) lines |= (1 << gpioPinOffset(pinsA[e]));
+  for (int run = 0; run < 20; run++) {
+    uint64_t t0 = nowNs();
+    for (int i = 0; i < 64; i++) {
+      sim_EXTI.PR1 = lines;
+      encoderEXTIHandler();
+    }
+    double ns = (double)(nowNs() - t0) / 64;
+    if (ns < best) best = ns;
+    encoderProcess();
+  }
+  return best;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Replay
+///////////////////////////////////////////////////////////////////////////////
+
+// Sets IDR to every encoder's pin levels
+static void drivePins(void) {
+  sim_GPIOA.IDR &= (1 << FOREIGN_LINE);
+  sim_GPIOB.IDR = 0;
+  for (int e = 0; e < ENCODERS; e++) {
+    uint8_t state = cwStates[enc[e].phase];
+    gpioPinToBase(pinsA[e])->IDR |= (uint32_t)(state >> 1) << gpioPinOffset(pinsA[e]);
+    gpioPinToBase(pinsB[e])->IDR |= (uint32_t)(state & 1) << gpioPinOffset(pinsB[e]);
+  }
+}
+
+static double jittered(double interval) {
+  return interval * (1.0 + JITTER * (2.0 * rand() / RAND_MAX - 1.0));
+}
+
+static benchResult replay(double rps, double seconds, const double cost[ENCODERS + 1]) {
+  benchResult r = {0, 0, 0, 0, 0, 0, 0};
+  uint64_t end = (uint64_t)(seconds * CORE_HZ);
+  double interval = CORE_HZ / (rps * COUNTS_PER_REV);
+  double foreignInterval = (double)CORE_HZ / FOREIGN_HZ;
+  double nextForeign = foreignInterval / 3;
+
+  sim_GPIOA.IDR = 0;
+  sim_GPIOB.IDR = 0;
+  encoderProcess();
+  uint32_t droppedBefore = encoderDropped();
+  for (int e = 0; e < ENCODERS; e++) {
+    encoderReset(enc[e].id);
+    enc[e].nextEdge = interval * (e + 1) / ENCODERS; // out of phase
+    enc[e].phase = 0;
+    enc[e].truth = 0;
+    enc[e].lastError = 0;
+  }
+  foreignDelivered = 0;
+
+  uint64_t cpuFree = 0, nextWindow = WINDOW_CYCLES;
+  uint32_t pending = 0;
+  uint64_t firstPending = 0;
+
+  for (;;) {
+    // Earliest event: an edge, the foreign pin or the window boundary
+    double next = nextForeign;
+    for (int e = 0; e < ENCODERS; e++) if (enc[e].nextEdge < next) next = enc[e].nextEdge;
+    if (!pending) firstPending = (uint64_t)next;
+    uint64_t entry = (firstPending > cpuFree ? firstPending : cpuFree) + ENTRY_CYCLES;
+
+    // The sampler closes every window that ends before this entry
+    while (nextWindow <= entry && nextWindow <= end) {
+      encoderProcess();
+      for (int e = 0; e < ENCODERS; e++) {
+        int32_t error = encoderPosition(enc[e].id) - enc[e].truth;
+        r.lost += abs(error - enc[e].lastError);
+        enc[e].lastError = error;
+      }
+      nextWindow += WINDOW_CYCLES;
+    }
+    if (entry > end) break;
+    uint64_t sample = entry + SAMPLE_CYCLES;
+
+    // Every edge up to the sample is in PR1 and in the pin levels the handler reads
+    for (;;) {
+      int who = -1;
+      double t = nextForeign;
+      for (int e = 0; e < ENCODERS; e++) if (enc[e].nextEdge < t) { t = enc[e].nextEdge; who = e; }
+      if ((uint64_t)t > sample) break;
+      if (who < 0) {
+        sim_GPIOA.IDR ^= (1 << FOREIGN_LINE);
+        pending |= (1 << FOREIGN_LINE);
+        r.foreignEdges++;
+        nextForeign += foreignInterval;
+      } else {
+        uint8_t old = cwStates[enc[who].phase];
+        enc[who].phase = (enc[who].phase + 1) & 3; // all CW: reversals are EDGE_REPLAY.c's business
+        pending |= (1 << gpioPinOffset((old ^ cwStates[enc[who].phase]) & 0b10 ? pinsA[who] : pinsB[who]));
+        enc[who].truth++;
+        enc[who].nextEdge += jittered(interval);
+      }
+    }
+
+    // Encoders with a pending line: the records this entry pushes
+    int moving = 0;
+    for (int e = 0; e < ENCODERS; e++)
+      if (pending & ((1 << gpioPinOffset(pinsA[e])) | (1 << gpioPinOffset(pinsB[e])))) moving++;
+
+    drivePins();
+    sim_EXTI.PR1 = pending;
+    encoderEXTIHandler();
+    pending &= ~sim_EXTI.PR1; // write-1-to-clear of what the handler wrote
+    r.entries++;
+    if (moving > 1) r.sharedEntries++;
+
+    uint64_t busy = ENTRY_CYCLES + (uint64_t)cost[moving] + EXIT_CYCLES;
+    r.busyCycles += busy;
+    cpuFree = entry - ENTRY_CYCLES + busy;
+    if (pending) firstPending = sample;
+  }
+
+  r.dropped = encoderDropped() - droppedBefore;
+
+  // Every entry takes at least one edge, unless a line stays pending and re-enters the handler
+  uint64_t edges = r.foreignEdges;
+  for (int e = 0; e < ENCODERS; e++) edges += enc[e].truth;
+  r.storm = r.entries > edges;
+  return r;
+}
+
+int main(int argc, char ** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: multi_bench <handler_cycles> [seconds] [seed]\n"
+                    "   handler_cycles: PROFILE_EXTI max= from the board's profile dump\n");
+    return 2;
+  }
+  double handlerCycles = atof(argv[1]);
+  double seconds = argc > 2 ? atof(argv[2]) : 2;
+  srand(argc > 3 ? atoi(argv[3]) : 1);
+
+  for (int e = 0; e < ENCODERS; e++) enc[e].id = encoderRegister(pinsA[e], pinsB[e]);
+  sim_EXTI.IMR1 |= (1 << FOREIGN_LINE); // the other driver's line, as its own init would unmask it
+  encoderOnOtherEXTI(onForeign);
+
+  // Handler cost by number of moving encoders, scaled from the board figure for one
+  double ns[ENCODERS + 1], cost[ENCODERS + 1];
+  for (int n = 1; n <= ENCODERS; n++) ns[n] = handlerNs(n);
+  cost[0] = handlerCycles;
+  for (int n = 1; n <= ENCODERS; n++) cost[n] = handlerCycles * ns[n] / ns[1];
+  printf("%d encoders, %.0f s per speed, handler %.0f cycles for 1 moving encoder", ENCODERS, seconds, handlerCycles);
+  for (int n = 2; n <= ENCODERS; n++) printf(", %.0f for %d", cost[n], n);
+  printf(" (host %.1f..%.1f ns)\n", ns[1], ns[ENCODERS]);
+  printf("queue %d records drained every %d ms\n", EDGE_QUEUE_LEN, SPEED_WINDOW_MS);
+
+  const double speeds[] = { 1, 5, 10, SPEED_DESIGN, 20, 30, 60 };
+  int fails = 0;
+  printf("%8s %10s %8s %9s %8s %8s %8s %9s\n", "rot/s", "edges/s", "EXTI %", "entries", "shared", "dropped", "lost", "foreign");
+  for (int row = 0; row < (int)(sizeof(speeds) / sizeof(speeds[0])); row++) {
+    benchResult r = replay(speeds[row], seconds, cost);
+    int design = speeds[row] <= SPEED_DESIGN;
+    int ok = r.dropped == 0 && r.lost == 0 && foreignDelivered == r.foreignEdges;
+    if (r.storm) printf("re-entry storm: %llu entries for fewer edges\n", (unsigned long long)r.entries);
+    if ((design && !ok) || r.storm) fails++;
+    printf("%8.0f %10.0f %8.2f %9llu %8llu %8u %8u %4u/%-4u %s\n", speeds[row], ENCODERS * speeds[row] * COUNTS_PER_REV,
+           100.0 * r.busyCycles / (seconds * CORE_HZ), (unsigned long long)r.entries,
+           (unsigned long long)r.sharedEntries, r.dropped, r.lost, foreignDelivered, r.foreignEdges,
+           design ? (ok ? "ok" : "FAIL") : "");
+  }
+  printf("%s\n", fails ? "FAIL" : "ok: no count lost up to the design speed, foreign line delivered, no re-entry storm");
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,81 @@
+// PROFILE_CHECK.c
+// Marina Bellido: mbellido@g.hmc.edu
+// Host check of the profileDump() text (lib/PROFILE.c). Times the real encoderEXTIHandler() under
+// PROFILE_EXTI and records a few PROFILE_CAPTURE durations and latencies, then dumps, and checks:
+//    -- the first line is the probe overhead profileInit() measured, no less than its part in each duration
+//    -- EXTI has its duration line and no latency line (it records none)
+//    -- CAPTURE has both, and profileClear() empties everything
+// On the host the figures are nanoseconds; on the board the same dump is in cycles.
+//
+// Build and run from lab5:
+//    gcc -O2 -Ihost -Ilib -o profile_check host/PROFILE_CHECK.c host/SIM_REGS.c lib/ENCODER.c lib/EDGE_QUEUE.c lib/PROFILE.c lib/FORMAT.c lib/STM32L432KC_GPIO.c
+//    ./profile_check
+
+#include <stdio.h>
+#include <string.h>
+
+#include "STM32L432KC.h"
+#include "ENCODER.h"
+#include "PROFILE.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define EDGES 10000
+
+static char dump[4096];
+static char * end = dump;
+
+// Output for profileDump(): shown, and kept for the checks
+static void collect(char * text) {
+  fputs(text, stdout);
+  end += snprintf(end, dump + sizeof(dump) - end, "%s", text);
+}
+
+static int check(int ok, const char * what) {
+  printf("%-48s %s\n", what, ok ? "ok" : "FAIL");
+  return !ok;
+}
+
+int main(void) {
+  static const uint8_t cwStates[4] = { QUAD_STATE(0, 0), QUAD_STATE(1, 0), QUAD_STATE(1, 1), QUAD_STATE(0, 1) };
+  sim_GPIOA.IDR = 0;
+  encoderRegister(PA6, PA8);
+  profileInit();
+
+  // The handler profiles itself under PROFILE_EXTI
+  for (int i = 1; i <= EDGES; i++) {
+    uint8_t state = cwStates[i & 3];
+    sim_GPIOA.IDR = ((uint32_t)(state >> 1) << 6) | ((uint32_t)(state & 1) << 8);
+    sim_EXTI.PR1 = (i & 1) ? (1 << 6) : (1 << 8);
+    encoderEXTIHandler();
+    encoderProcess();
+  }
+  for (int i = 0; i < 4; i++) {
+    profileDuration(PROFILE_CAPTURE, 40);
+    profileLatency(PROFILE_CAPTURE, 80);
+  }
+
+  profileDump(collect);
+  int fails = 0;
+  fails += check(strncmp(dump, "probe overhead=", 15) == 0, "overhead first");
+  unsigned overhead = 0, inside = UINT32_MAX;
+  sscanf(dump, "probe overhead=%u (%u", &overhead, &inside);
+  fails += check(inside <= overhead, "part in each duration <= overhead");
+  char * exti = strstr(dump, "EXTI: n=10000 ");
+  char * capture = strstr(dump, "CAPTURE: n=4 ");
+  fails += check(exti && strstr(exti, "  duration"), "EXTI duration");
+  fails += check(exti && capture && strstr(exti, "  latency ") == strstr(capture, "  latency "), "no EXTI latency line");
+  fails += check(capture && strstr(capture, "  latency  <2^7:4"), "CAPTURE latency");
+
+  profileClear();
+  end = dump;
+  *end = 0;
+  printf("after profileClear():\n");
+  profileDump(collect);
+  fails += check(strchr(dump, '\n') == end - 1, "only the overhead line left");
+
+  printf("%s\n", fails ? "FAIL" : "ok");
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,15 @@
+// SIM_REGS.c
+// Marina Bellido: mbellido@g.hmc.edu
+// Simulated peripherals of the host register model (host/stm32l432xx.h), linked into every host test
+
+#include "stm32l432xx.h"
+
+uint32_t SystemCoreClock = 80000000;
+
+GPIO_TypeDef sim_GPIOA, sim_GPIOB, sim_GPIOC;
+RCC_TypeDef sim_RCC;
+SYSCFG_TypeDef sim_SYSCFG;
+EXTI_TypeDef sim_EXTI;
+NVIC_Type sim_NVIC;
+TIM_TypeDef sim_TIM1, sim_TIM6, sim_TIM16;
+USART_TypeDef sim_USART1, sim_USART2;
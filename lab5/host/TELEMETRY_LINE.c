@@ -0,0 +1,37 @@
+// TELEMETRY_LINE.c
+// Marina Bellido: mbellido@g.hmc.edu
+// The telemetry line alone, built one of two ways so host/size.sh can compare their code size:
+//    -- TELEMETRY_PRINTF 1: the original float division and printf("%.3f")
+//    -- TELEMETRY_PRINTF 0: speedEstimate() and FORMAT.c, written out with fputs()
+// The edge count comes from a volatile so the compiler cannot fold the line away.
+
+#include <stdio.h>
+
+#include "FORMAT.h"
+#include "SPEED.h"
+
+#ifndef TELEMETRY_PRINTF
+#define TELEMETRY_PRINTF 0
+#endif
+
+volatile int counter = 1632;
+
+int main(void) {
+#if TELEMETRY_PRINTF
+  float speed = (float)counter/1632; // 408*4
+  printf("\nCurrent speed: %.3f rotations/s", speed);
+  if (speed != 0.0) printf(" : CW direction");
+#else
+  char line[64];
+  int method;
+  uint32_t speed = speedEstimate(counter, 0, 1000, &method);
+  char * p = line;
+  p = formatString(p, "\nCurrent speed: ");
+  p = formatMilli(p, speed);
+  p = formatString(p, " rotations/s");
+  if (speed != 0) p = formatString(p, " : CW direction");
+  *p = 0;
+  fputs(line, stdout);
+#endif
+  return 0;
+}
@@ -0,0 +1,55 @@
+#!/bin/sh
+# Filename: check.sh
+# Marina Bellido: mbellido@g.hmc.edu
+# Oct 9, 2025
+
+# Host regression checks for lab5: builds the host tests against the register model in
+# host/stm32l432xx.h and runs them; any failing test fails the check. main.c is syntax-checked in
+# both encoder modes.
+#
+# Run from lab5:
+#    sh host/check.sh
+
+set -e
+out=${TMPDIR:-/tmp}/lab5_check
+mkdir -p "$out/tim"
+cc="gcc -O2 -Wall -Werror -Ihost -Ilib -Isrc"
+
+run() {
+    "$@" || { echo "FAIL: $*"; exit 1; }
+}
+
+# main.c as configured (EXTI) and with ENCODER_MODE_TIM
+$cc -fsyntax-only src/main.c
+sed 's/^#define ENCODER_MODE ENCODER_MODE_EXTI/#define ENCODER_MODE ENCODER_MODE_TIM/' src/main.h > "$out/tim/main.h"
+cp src/main.c "$out/tim/main.c"
+$cc -fsyntax-only "$out/tim/main.c"
+$cc -fsyntax-only lib/STM32L432KC_USART.c
+
+$cc -o "$out/encoder_tim_check" host/ENCODER_TIM_CHECK.c host/SIM_REGS.c lib/STM32L432KC_TIM.c
+run "$out/encoder_tim_check"
+
+enc="lib/ENCODER.c lib/EDGE_QUEUE.c lib/PROFILE.c lib/FORMAT.c lib/STM32L432KC_GPIO.c"
+$cc -o "$out/decode_bench" host/DECODE_BENCH.c host/SIM_REGS.c $enc
+run "$out/decode_bench" 200000 5
+
+# Edge replay with both illegal-transition settings (150-cycle handler: past it, pairs collapse)
+$cc -o "$out/edge_replay" host/EDGE_REPLAY.c host/SIM_REGS.c $enc
+$cc -DENCODER_RECOVER_ILLEGAL=1 -o "$out/edge_replay_recover" host/EDGE_REPLAY.c host/SIM_REGS.c $enc
+run "$out/edge_replay" 150 200000
+run "$out/edge_replay_recover" 150 200000
+
+# Four encoders at once, plus a foreign line on a shared EXTI vector
+$cc -o "$out/multi_bench" host/MULTI_BENCH.c host/SIM_REGS.c $enc
+run "$out/multi_bench" 150 0.5
+
+# Profile dump: probe overhead first, no latency line for probes that record none
+$cc -o "$out/profile_check" host/PROFILE_CHECK.c host/SIM_REGS.c $enc
+run "$out/profile_check"
+
+# Telemetry line: integer speed + FORMAT.c against the original float + printf, time and size
+$cc -o "$out/format_bench" host/FORMAT_BENCH.c lib/FORMAT.c lib/SPEED.c
+run "$out/format_bench" 20000 5
+sh host/size.sh
+
+echo "all checks passed"
@@ -0,0 +1,37 @@
+#!/bin/sh
+# Filename: size.sh
+# Marina Bellido: mbellido@g.hmc.edu
+# Oct 9, 2025
+
+# Code size of the telemetry line (host/TELEMETRY_LINE.c) built the original way (float + printf)
+# and the current way (speedEstimate() + FORMAT.c), as `size` output:
+#    -- objects: the line's own code, plus SPEED.o and FORMAT.o for the current way
+#    -- images: both linked. Only meaningful with the board's toolchain: a host glibc pulls in the
+#       whole printf either way, so there the object lines are the ones to read.
+#
+# Run from lab5, on the host or with the board's toolchain:
+#    sh host/size.sh
+#    CC=arm-none-eabi-gcc CFLAGS="-Os -mcpu=cortex-m4 -mthumb -mfloat-abi=hard -mfpu=fpv4-sp-d16" \
+#        LDFLAGS="--specs=nano.specs --specs=nosys.specs -u _printf_float" SIZE=arm-none-eabi-size sh host/size.sh
+
+set -e
+out=${TMPDIR:-/tmp}/lab5_size
+mkdir -p "$out"
+CC=${CC:-gcc}
+CFLAGS=${CFLAGS:--O2}
+SIZE=${SIZE:-size}
+cc="$CC $CFLAGS -Wall -Werror -Ilib"
+
+$cc -DTELEMETRY_PRINTF=1 -c -o "$out/line_printf.o" host/TELEMETRY_LINE.c
+$cc -DTELEMETRY_PRINTF=0 -c -o "$out/line_format.o" host/TELEMETRY_LINE.c
+$cc -c -o "$out/SPEED.o" lib/SPEED.c
+$cc -c -o "$out/FORMAT.o" lib/FORMAT.c
+$cc $LDFLAGS -o "$out/line_printf" "$out/line_printf.o"
+$cc $LDFLAGS -o "$out/line_format" "$out/line_format.o" "$out/SPEED.o" "$out/FORMAT.o"
+
+echo "objects, float + printf:"
+$SIZE "$out/line_printf.o"
+echo "objects, speedEstimate + FORMAT.c:"
+$SIZE -t "$out/line_format.o" "$out/SPEED.o" "$out/FORMAT.o"
+echo "images ($CC $LDFLAGS):"
+$SIZE "$out/line_printf" "$out/line_format"
@@ -0,0 +1,189 @@
+// stm32l432xx.h (host)
+// Marina Bellido: mbellido@g.hmc.edu
+// Host register model standing in for the CMSIS device header, so lib/ compiles unchanged with gcc
+// (build with -Ihost ahead of -Ilib). Every peripheral is a plain struct in memory (SIM_REGS.c):
+// writes just store, nothing reacts to them. Tests play the hardware around the code under test:
+//    -- EXTI->PR1 is write-1-to-clear on the board; here it holds the last value written, and the
+//       test clears those bits from its own pending set after each handler call
+//    -- GPIOx->IDR is set by the test to the pin levels the ISR should sample
+// Only the registers and fields lab5 uses are modelled (lib/ and src/main.c, which only gets syntax-checked).
+
+#ifndef STM32L432XX_H
+#define STM32L432XX_H
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Core
+///////////////////////////////////////////////////////////////////////////////
+
+typedef enum {
+  EXTI0_IRQn          = 6,
+  EXTI1_IRQn          = 7,
+  EXTI2_IRQn          = 8,
+  EXTI3_IRQn          = 9,
+  EXTI4_IRQn          = 10,
+  EXTI9_5_IRQn        = 23,
+  TIM1_UP_TIM16_IRQn  = 25,
+  USART2_IRQn         = 38,
+  EXTI15_10_IRQn      = 40,
+  TIM6_DAC_IRQn       = 54
+} IRQn_Type;
+
+typedef struct {
+  volatile uint32_t ISER[8];
+  volatile uint32_t ICER[8];
+  volatile uint32_t ISPR[8];
+  volatile uint32_t ICPR[8];
+  volatile uint32_t IABR[8];
+  volatile uint8_t  IP[240];
+} NVIC_Type;
+
+static inline uint32_t __CLZ(uint32_t value) { return value ? (uint32_t)__builtin_clz(value) : 32; }
+static inline void __enable_irq(void) {}
+static inline void __WFI(void) {}
+
+#define _VAL2FLD(field, value) (((uint32_t)(value) << field ## _Pos) & field ## _Msk)
+
+extern uint32_t SystemCoreClock;
+
+///////////////////////////////////////////////////////////////////////////////
+// Peripherals
+///////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+  volatile uint32_t MODER, OTYPER, OSPEEDR, PUPDR, IDR, ODR, BSRR, LCKR;
+  volatile uint32_t AFR[2];
+  volatile uint32_t BRR;
+} GPIO_TypeDef;
+
+typedef struct {
+  volatile uint32_t CR, ICSCR, CFGR, PLLCFGR;
+  volatile uint32_t AHB1ENR, AHB2ENR, AHB3ENR;
+  volatile uint32_t APB1ENR1, APB1ENR2, APB2ENR;
+  volatile uint32_t CCIPR;
+} RCC_TypeDef;
+
+typedef struct {
+  volatile uint32_t MEMRMP, CFGR1;
+  volatile uint32_t EXTICR[4];
+} SYSCFG_TypeDef;
+
+typedef struct {
+  volatile uint32_t IMR1, EMR1, RTSR1, FTSR1, SWIER1, PR1;
+} EXTI_TypeDef;
+
+typedef struct {
+  volatile uint32_t CR1, CR2, SMCR, DIER, SR, EGR, CCMR1, CCMR2, CCER, CNT, PSC, ARR, RCR;
+  volatile uint32_t CCR1, CCR2, CCR3, CCR4;
+} TIM_TypeDef;
+
+typedef struct {
+  volatile uint32_t CR1, CR2, CR3, BRR, GTPR, RTOR, RQR, ISR, ICR, RDR, TDR;
+} USART_TypeDef;
+
+extern GPIO_TypeDef sim_GPIOA, sim_GPIOB, sim_GPIOC;
+extern RCC_TypeDef sim_RCC;
+extern SYSCFG_TypeDef sim_SYSCFG;
+extern EXTI_TypeDef sim_EXTI;
+extern NVIC_Type sim_NVIC;
+extern TIM_TypeDef sim_TIM1, sim_TIM6, sim_TIM16;
+extern USART_TypeDef sim_USART1, sim_USART2;
+
+#define GPIOA_BASE ((uintptr_t)&sim_GPIOA)
+#define GPIOB_BASE ((uintptr_t)&sim_GPIOB)
+#define GPIOC_BASE ((uintptr_t)&sim_GPIOC)
+#define GPIOA  ((GPIO_TypeDef *)GPIOA_BASE)
+#define GPIOB  ((GPIO_TypeDef *)GPIOB_BASE)
+#define GPIOC  ((GPIO_TypeDef *)GPIOC_BASE)
+#define RCC    (&sim_RCC)
+#define SYSCFG (&sim_SYSCFG)
+#define EXTI   (&sim_EXTI)
+#define NVIC   (&sim_NVIC)
+#define TIM1   (&sim_TIM1)
+#define TIM6   (&sim_TIM6)
+#define TIM16  (&sim_TIM16)
+#define USART1 (&sim_USART1)
+#define USART2 (&sim_USART2)
+
+///////////////////////////////////////////////////////////////////////////////
+// Fields
+///////////////////////////////////////////////////////////////////////////////
+
+#define GPIO_PUPDR_PUPD6_Pos    12
+#define GPIO_PUPDR_PUPD6_Msk    (0x3U << GPIO_PUPDR_PUPD6_Pos)
+#define GPIO_PUPDR_PUPD8_Pos    16
+#define GPIO_PUPDR_PUPD8_Msk    (0x3U << GPIO_PUPDR_PUPD8_Pos)
+#define GPIO_PUPDR_PUPD9_Pos    18
+#define GPIO_PUPDR_PUPD9_Msk    (0x3U << GPIO_PUPDR_PUPD9_Pos)
+#define GPIO_AFRL_AFSEL2_Pos    8
+#define GPIO_AFRL_AFSEL2_Msk    (0xFU << GPIO_AFRL_AFSEL2_Pos)
+#define GPIO_AFRL_AFSEL6_Pos    24
+#define GPIO_AFRL_AFSEL6_Msk    (0xFU << GPIO_AFRL_AFSEL6_Pos)
+#define GPIO_AFRH_AFSEL8_Pos    0
+#define GPIO_AFRH_AFSEL8_Msk    (0xFU << GPIO_AFRH_AFSEL8_Pos)
+#define GPIO_AFRH_AFSEL9_Pos    4
+#define GPIO_AFRH_AFSEL9_Msk    (0xFU << GPIO_AFRH_AFSEL9_Pos)
+#define GPIO_AFRH_AFSEL10_Pos   8
+#define GPIO_AFRH_AFSEL10_Msk   (0xFU << GPIO_AFRH_AFSEL10_Pos)
+#define GPIO_AFRH_AFSEL15_Pos   28
+#define GPIO_AFRH_AFSEL15_Msk   (0xFU << GPIO_AFRH_AFSEL15_Pos)
+
+#define RCC_CR_HSION            (1U << 8)
+#define RCC_AHB2ENR_GPIOAEN     (1U << 0)
+#define RCC_AHB2ENR_GPIOBEN     (1U << 1)
+#define RCC_AHB2ENR_GPIOCEN     (1U << 2)
+#define RCC_APB1ENR1_TIM6EN     (1U << 4)
+#define RCC_APB1ENR1_USART2EN   (1U << 17)
+#define RCC_APB2ENR_SYSCFGEN    (1U << 0)
+#define RCC_APB2ENR_TIM1EN      (1U << 11)
+#define RCC_APB2ENR_USART1EN    (1U << 14)
+#define RCC_APB2ENR_TIM16EN     (1U << 17)
+#define RCC_CCIPR_USART1SEL_Pos 0
+#define RCC_CCIPR_USART2SEL_Pos 2
+
+#define TIM_CR1_CEN             (1U << 0)
+#define TIM_CR1_URS             (1U << 2)
+#define TIM_SMCR_SMS_Pos        0
+#define TIM_SMCR_SMS_Msk        (0x10007U)
+#define TIM_SMCR_SMS            TIM_SMCR_SMS_Msk
+#define TIM_DIER_UIE            (1U << 0)
+#define TIM_DIER_CC1IE          (1U << 1)
+#define TIM_SR_UIF              (1U << 0)
+#define TIM_SR_CC1IF            (1U << 1)
+#define TIM_EGR_UG              (1U << 0)
+#define TIM_CCMR1_CC1S_Pos      0
+#define TIM_CCMR1_CC1S_Msk      (0x3U << TIM_CCMR1_CC1S_Pos)
+#define TIM_CCMR1_CC1S          TIM_CCMR1_CC1S_Msk
+#define TIM_CCMR1_IC1PSC_Pos    2
+#define TIM_CCMR1_IC1PSC_Msk    (0x3U << TIM_CCMR1_IC1PSC_Pos)
+#define TIM_CCMR1_IC1PSC        TIM_CCMR1_IC1PSC_Msk
+#define TIM_CCMR1_IC1F_Pos      4
+#define TIM_CCMR1_IC1F_Msk      (0xFU << TIM_CCMR1_IC1F_Pos)
+#define TIM_CCMR1_IC1F          TIM_CCMR1_IC1F_Msk
+#define TIM_CCMR1_CC2S_Pos      8
+#define TIM_CCMR1_CC2S_Msk      (0x3U << TIM_CCMR1_CC2S_Pos)
+#define TIM_CCMR1_CC2S          TIM_CCMR1_CC2S_Msk
+#define TIM_CCMR1_IC2F_Pos      12
+#define TIM_CCMR1_IC2F_Msk      (0xFU << TIM_CCMR1_IC2F_Pos)
+#define TIM_CCMR1_IC2F          TIM_CCMR1_IC2F_Msk
+#define TIM_CCER_CC1E           (1U << 0)
+#define TIM_CCER_CC1P           (1U << 1)
+#define TIM_CCER_CC1NP          (1U << 3)
+#define TIM_CCER_CC2P           (1U << 5)
+#define TIM_CCER_CC2NP          (1U << 7)
+
+#define USART_CR1_UE            (1U << 0)
+#define USART_CR1_RE            (1U << 2)
+#define USART_CR1_TE            (1U << 3)
+#define USART_CR1_M0            (1U << 12)
+#define USART_CR1_OVER8         (1U << 15)
+#define USART_CR1_M1            (1U << 28)
+#define USART_CR2_STOP          (0x3U << 12)
+#define USART_ISR_ORE           (1U << 3)
+#define USART_ISR_RXNE          (1U << 5)
+#define USART_ISR_TC            (1U << 6)
+#define USART_ISR_TXE           (1U << 7)
+#define USART_ICR_ORECF         (1U << 3)
+
+#endif
@@ -0,0 +1,46 @@
+// EDGE_QUEUE.c
+// Marina Bellido: mbellido@g.hmc.edu
+// Single-producer/single-consumer ring buffer: the encoder ISR pushes timestamped
+// edges and a lower-priority consumer drains them whenever it gets around to it. No locks or
+// disabled interrupts are needed because each index has exactly one writer.
+
+#include "EDGE_QUEUE.h"
+
+#define EDGE_QUEUE_MASK (EDGE_QUEUE_LEN - 1)
+
+void edgeQueueInit(edgeQueue * q) {
+  q->head = 0;
+  q->tail = 0;
+  q->overflows = 0;
+}
+
+int edgeQueuePush(edgeQueue * q, uint32_t timestamp, uint8_t id, uint8_t state) {
+  uint32_t head = q->head;
+
+  if (head - q->tail >= EDGE_QUEUE_LEN) { // full: keep the old records, count the loss
+    q->overflows++;
+    return 0;
+  }
+
+  q->buf[head & EDGE_QUEUE_MASK].timestamp = timestamp;
+  q->buf[head & EDGE_QUEUE_MASK].id = id;
+  q->buf[head & EDGE_QUEUE_MASK].state = state;
+  q->head = head + 1; // publish only after the record is written (all volatile, so stores stay in order)
+  return 1;
+}
+
+int edgeQueuePop(edgeQueue * q, edgeRecord * rec) {
+  uint32_t tail = q->tail;
+
+  if (tail == q->head) return 0; // empty
+
+  rec->timestamp = q->buf[tail & EDGE_QUEUE_MASK].timestamp;
+  rec->id = q->buf[tail & EDGE_QUEUE_MASK].id;
+  rec->state = q->buf[tail & EDGE_QUEUE_MASK].state;
+  q->tail = tail + 1; // hand the slot back to the producer
+  return 1;
+}
+
+uint32_t edgeQueueCount(edgeQueue * q) {
+  return q->head - q->tail;
+}
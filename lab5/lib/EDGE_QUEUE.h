@@ -0,0 +1,53 @@
+// EDGE_QUEUE.h
+// Marina Bellido: mbellido@g.hmc.edu
+// Header for the lock-free single-producer/single-consumer queue of encoder edges
+
+#ifndef EDGE_QUEUE_H
+#define EDGE_QUEUE_H
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+// Number of records, must be a power of 2. The sampler drains it once per 10 ms window, so it holds
+// one window of ENCODER_MAX encoders at 15 rotations/s (~980 records, host/MULTI_BENCH.c): 8 KB of RAM.
+#define EDGE_QUEUE_LEN 1024
+
+// One encoder edge as seen by the ISR
+typedef struct {
+  uint32_t timestamp; // cycle count when the edge was serviced
+  uint8_t  id;        // which encoder moved
+  uint8_t  state;     // (A << 1) | B right after the edge
+} edgeRecord;
+
+// Only the producer (EXTI ISR) writes head and overflows, only the consumer writes tail.
+// Indices run freely and are masked on access, so head - tail is always the fill level.
+typedef struct {
+  volatile edgeRecord buf[EDGE_QUEUE_LEN];
+  volatile uint32_t head;      // next slot to write
+  volatile uint32_t tail;      // next slot to read
+  volatile uint32_t overflows; // records dropped because the queue was full
+} edgeQueue;
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+/* Empties the queue and clears its overflow counter (call before enabling the producer). */
+void edgeQueueInit(edgeQueue * q);
+
+/* Appends a record (producer side, ISR only).
+ *    -- return: 1 if stored, 0 if the queue was full and the record was counted as an overflow */
+int edgeQueuePush(edgeQueue * q, uint32_t timestamp, uint8_t id, uint8_t state);
+
+/* Removes the oldest record (consumer side: one context only, e.g. the sampler ISR).
+ *    -- rec: where to copy the record
+ *    -- return: 1 if a record was copied, 0 if the queue was empty */
+int edgeQueuePop(edgeQueue * q, edgeRecord * rec);
+
+/* Returns how many records are waiting to be read */
+uint32_t edgeQueueCount(edgeQueue * q);
+
+#endif
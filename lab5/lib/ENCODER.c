@@ -0,0 +1,194 @@
+// ENCODER.c
+// Marina Bellido: mbellido@g.hmc.edu
+// Table-driven quadrature decoder for up to ENCODER_MAX encoders on any EXTI lines.
+// Each edge costs one table load and one add into a signed 32-bit position.
+// Per-encoder state is kept as parallel arrays indexed by encoder id, so decoding
+// one encoder touches one entry of each array and nothing else.
+
+#include "STM32L432KC.h"
+#include "ENCODER.h"
+#include "PROFILE.h"
+
+// Transition table indexed by (prev << 2) | next, with states encoded as (A << 1) | B.
+// CW sequence is 00 -> 10 -> 11 -> 01 -> 00 (A leads B), CCW is the reverse.
+const int8_t quadTable[16] = {
+//  next:  00          01          10          11
+/* 00 */   QUAD_NONE,  QUAD_CCW,   QUAD_CW,    QUAD_ERROR,
+/* 01 */   QUAD_CW,    QUAD_NONE,  QUAD_ERROR, QUAD_CCW,
+/* 10 */   QUAD_CCW,   QUAD_ERROR, QUAD_NONE,  QUAD_CW,
+/* 11 */   QUAD_ERROR, QUAD_CW,    QUAD_CCW,   QUAD_NONE
+};
+
+// Decoder state (touched only by whoever calls encoderProcess())
+static int32_t  positions[ENCODER_MAX]; // signed edges, CW positive
+static uint8_t  prevState[ENCODER_MAX]; // last decoded A/B state
+static encoderStats stats[ENCODER_MAX]; // illegal transitions, double edges and reversals
+static int8_t   lastStep[ENCODER_MAX];  // direction of the last legal edge, used to recover double steps
+
+// Pin lookup for the EXTI handler, resolved once at registration (no gpioPinToBase() in the ISR)
+static GPIO_TypeDef * portA[ENCODER_MAX];
+static GPIO_TypeDef * portB[ENCODER_MAX];
+static uint8_t bitA[ENCODER_MAX];
+static uint8_t bitB[ENCODER_MAX];
+static uint32_t lineIds[16];   // EXTI line -> bit of the encoder that owns it
+static uint32_t lineMask = 0;  // all EXTI lines owned by encoders
+static int encoderCount = 0;
+static void (*volatile otherLines)(uint32_t lines); // pending lines no encoder owns, see encoderOnOtherEXTI()
+
+static edgeQueue encoderEdges; // pushed by encoderEXTIHandler(), drained by encoderProcess()
+
+// Reads one encoder's A/B pins with at most two IDR loads
+static uint8_t readState(int id) {
+  uint32_t idrA = portA[id]->IDR;
+  uint32_t idrB = (portB[id] == portA[id]) ? idrA : portB[id]->IDR;
+  return QUAD_STATE((idrA >> bitA[id]) & 1, (idrB >> bitB[id]) & 1);
+}
+
+// NVIC vector serving a given EXTI line
+static int lineToIRQ(int line) {
+  if (line <= 4) return EXTI0_IRQn + line; // EXTI0..EXTI4 have their own vectors
+  if (line <= 9) return EXTI9_5_IRQn;
+  return EXTI15_10_IRQn;
+}
+
+// Routes one pin to its EXTI line and enables both-edge interrupts on it
+static void enableLine(int pin) {
+  int line = gpioPinOffset(pin);
+  int irq = lineToIRQ(line);
+
+  // EXTICR[line/4] holds 4-bit port selectors (0 = A, 1 = B, 2 = C)
+  SYSCFG->EXTICR[line >> 2] &= ~(0xF << (4 * (line & 3)));
+  SYSCFG->EXTICR[line >> 2] |= (gpioPinToPort(pin) << (4 * (line & 3)));
+
+  EXTI->IMR1  |= (1 << line); // Unmask the line
+  EXTI->RTSR1 |= (1 << line); // Rising edge trigger
+  EXTI->FTSR1 |= (1 << line); // Falling edge trigger
+  NVIC->ISER[irq >> 5] |= (1 << (irq & 31));
+}
+
+int8_t quadDecode(uint8_t prev, uint8_t next) {
+  return quadTable[((prev & 0b11) << 2) | (next & 0b11)];
+}
+
+int encoderRegister(int pinA, int pinB) {
+  int lineA = gpioPinOffset(pinA);
+  int lineB = gpioPinOffset(pinB);
+  uint32_t lines = (1 << lineA) | (1 << lineB);
+
+  if (encoderCount >= ENCODER_MAX || lineA == lineB || (lineMask & lines)) return -1;
+  int id = encoderCount;
+
+  // Pulled-down digital inputs
+  gpioEnable(gpioPinToPort(pinA));
+  gpioEnable(gpioPinToPort(pinB));
+  pinMode(pinA, GPIO_INPUT);
+  pinMode(pinB, GPIO_INPUT);
+  gpioPinToBase(pinA)->PUPDR = (gpioPinToBase(pinA)->PUPDR & ~(0b11 << 2*lineA)) | (0b10 << 2*lineA);
+  gpioPinToBase(pinB)->PUPDR = (gpioPinToBase(pinB)->PUPDR & ~(0b11 << 2*lineB)) | (0b10 << 2*lineB);
+
+  portA[id] = gpioPinToBase(pinA);
+  portB[id] = gpioPinToBase(pinB);
+  bitA[id] = lineA;
+  bitB[id] = lineB;
+  encoderReset(id);
+
+  // Publish the lines to the handler before they can fire
+  lineIds[lineA] = 1 << id;
+  lineIds[lineB] = 1 << id;
+  lineMask |= lines;
+  encoderCount++;
+
+  RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN; // EXTI port selection lives in SYSCFG
+  enableLine(pinA);
+  enableLine(pinB);
+  return id;
+}
+
+void encoderReset(int id) {
+  prevState[id] = readState(id);
+  positions[id] = 0;
+  stats[id].illegal = 0;
+  stats[id].doubles = 0;
+  stats[id].reversals = 0;
+  lastStep[id] = 0;
+}
+
+void encoderUpdate(int id, uint8_t state) {
+  int8_t step = quadTable[(prevState[id] << 2) | state];
+  prevState[id] = state;
+
+  if (step == QUAD_ERROR) {
+    // Both channels changed since the last pass (two edges landed in one ISR entry).
+    // The order is lost: either drop it or assume both edges went the way the shaft was already turning.
+    stats[id].illegal++;
+    if (ENCODER_RECOVER_ILLEGAL) positions[id] += 2 * lastStep[id];
+  } else if (step == QUAD_NONE) {
+    // The line fired but the pins are back where they were: a glitch pulse or bounce
+    stats[id].doubles++;
+  } else {
+    if (step == -lastStep[id]) stats[id].reversals++;
+    positions[id] += step;
+    lastStep[id] = step;
+  }
+}
+
+void encoderProcess(void) {
+  edgeRecord edge;
+  while (edgeQueuePop(&encoderEdges, &edge)) encoderUpdate(edge.id, edge.state);
+}
+
+void encoderEXTIHandler(void) {
+  uint32_t stamp = profileNow(); // DWT cycle count: edge timestamp and profiling start
+
+  // Latch the pending lines before sampling pins: an edge landing in between shows up in the
+  // snapshot and keeps its pending bit, so the next entry just sees "no change".
+  // Every unmasked GPIO line is taken, not only the encoders': another pin on a shared vector
+  // (EXTI9_5, EXTI15_10) would otherwise stay pending and re-enter this handler forever.
+  uint32_t pending = EXTI->PR1 & EXTI->IMR1 & EXTI_GPIO_LINES;
+  EXTI->PR1 = pending; // write-1-to-clear exactly the lines handled here
+  uint32_t others = pending & ~lineMask;
+  pending &= lineMask;
+
+  // Collapse pending lines into the set of encoders that moved (A and B of one encoder -> one record)
+  uint32_t ids = 0;
+  while (pending) {
+    int line = 31 - __CLZ(pending); // highest pending line
+    ids |= lineIds[line];
+    pending &= ~(1 << line);
+  }
+
+  // One snapshot and one record per moving encoder
+  while (ids) {
+    int id = 31 - __CLZ(ids);
+    ids &= ~(1 << id);
+    edgeQueuePush(&encoderEdges, stamp, id, readState(id));
+  }
+
+  if (others && otherLines) otherLines(others);
+  PROFILE_END(PROFILE_EXTI, stamp);
+}
+
+void encoderOnOtherEXTI(void (*handler)(uint32_t lines)) {
+  otherLines = handler;
+}
+
+int32_t encoderPosition(int id) {
+  return positions[id];
+}
+
+void encoderReadStats(int id, encoderStats * out) {
+  *out = stats[id];
+}
+
+uint32_t encoderDropped(void) {
+  return encoderEdges.overflows;
+}
+
+// Every EXTI vector an encoder line can land on goes to the same handler
+void EXTI0_IRQHandler(void)     { encoderEXTIHandler(); }
+void EXTI1_IRQHandler(void)     { encoderEXTIHandler(); }
+void EXTI2_IRQHandler(void)     { encoderEXTIHandler(); }
+void EXTI3_IRQHandler(void)     { encoderEXTIHandler(); }
+void EXTI4_IRQHandler(void)     { encoderEXTIHandler(); }
+void EXTI9_5_IRQHandler(void)   { encoderEXTIHandler(); }
+void EXTI15_10_IRQHandler(void) { encoderEXTIHandler(); }
@@ -0,0 +1,94 @@
+// ENCODER.h
+// Marina Bellido: mbellido@g.hmc.edu
+// Header for quadrature decoding functions (table-driven, signed position, several encoders)
+
+#ifndef ENCODER_H
+#define ENCODER_H
+
+#include <stdint.h>
+#include "EDGE_QUEUE.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define ENCODER_MAX 4 // encoders that can be registered (each uses two EXTI lines)
+#define EXTI_GPIO_LINES 0xFFFF // EXTI0..15: the GPIO lines, all served by encoderEXTIHandler()
+
+// Values held in the transition table
+#define QUAD_CW     1 // one edge clockwise (A leads B)
+#define QUAD_NONE   0 // no change
+#define QUAD_CCW   -1 // one edge counter-clockwise (B leads A)
+#define QUAD_ERROR  2 // A and B both changed: an edge was missed
+
+// Quadrature state encoding: (A << 1) | B
+#define QUAD_STATE(a, b) ((uint8_t)(((a) << 1) | (b)))
+
+// What encoderUpdate() does with an illegal transition (both channels changed at once):
+//    0 -> reject it: counted in the stats, position untouched. Loses 2 counts per illegal transition,
+//         none at the encoder's full speed, where no pair collapses.
+//    1 -> recover it as two edges in the last legal direction (opt-in, -DENCODER_RECOVER_ILLEGAL=1).
+//         Guesses, but is lossless while the handler sees at most two edges between samples and a pair
+//         goes the way of the last single edge (host/EDGE_REPLAY.c measures both settings).
+// Neither can see three edges between samples: they read as one edge the other way.
+#ifndef ENCODER_RECOVER_ILLEGAL
+#define ENCODER_RECOVER_ILLEGAL 0
+#endif
+
+// Signal integrity counters for one encoder (since registration/reset)
+typedef struct {
+  uint32_t illegal;   // both channels changed between two snapshots: at least one edge was missed
+  uint32_t doubles;   // a line fired but A/B were unchanged: an edge and its undo landed together (glitch/bounce)
+  uint32_t reversals; // legal edge in the opposite direction of the previous one
+} encoderStats;
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+/* Looks up the transition between two quadrature states.
+ *    -- prev, next: states built with QUAD_STATE()
+ *    -- return: QUAD_CW, QUAD_CCW, QUAD_NONE or QUAD_ERROR */
+int8_t quadDecode(uint8_t prev, uint8_t next);
+
+/* Registers an encoder: sets both pins as pulled-down inputs, routes their EXTI lines,
+ * enables both-edge triggers and turns on the matching NVIC vector(s).
+ * The pins must sit on two different pin numbers not used by another encoder
+ * (EXTI line n serves pin n of only one port).
+ *    -- pinA, pinB: GPIO pins, e.g. PA6 and PA8
+ *    -- return: encoder id (0 .. ENCODER_MAX-1), or -1 if it cannot be registered */
+int encoderRegister(int pinA, int pinB);
+
+/* Re-seeds an encoder from its pins and zeroes its position and stats. */
+void encoderReset(int id);
+
+/* Feeds a new A/B state to one encoder's decoder and updates its stats.
+ * An illegal transition is rejected or recovered depending on ENCODER_RECOVER_ILLEGAL.
+ *    -- state: pins, built with QUAD_STATE() */
+void encoderUpdate(int id, uint8_t state);
+
+/* Decodes every edge queued by the EXTI handler (call from one context only, e.g. the sampler ISR). */
+void encoderProcess(void);
+
+/* Shared EXTI handler for all registered encoders: one timestamped record per encoder that moved.
+ * It clears every pending GPIO line it is entered for; lines no encoder owns go to encoderOnOtherEXTI(). */
+void encoderEXTIHandler(void);
+
+/* Sets the function the EXTI handler calls, from the interrupt, with the pending lines no encoder owns
+ * (another driver's pins: ENCODER.c defines every EXTI0..15 vector). Those lines are cleared either
+ * way, so without a handler their edges are dropped rather than re-entering the interrupt forever.
+ *    -- handler: takes a mask of EXTI lines, or NULL */
+void encoderOnOtherEXTI(void (*handler)(uint32_t lines));
+
+/* Returns the signed edge count accumulated since registration/reset */
+int32_t encoderPosition(int id);
+
+/* Copies one encoder's signal integrity counters.
+ * Illegal transitions climbing with speed mean edges arrive faster than the ISR can sample them.
+ *    -- stats: filled with the counts since registration/reset */
+void encoderReadStats(int id, encoderStats * stats);
+
+/* Returns how many edge records were dropped because the queue was full (all encoders) */
+uint32_t encoderDropped(void);
+
+#endif
@@ -0,0 +1,37 @@
+// FORMAT.c
+// Marina Bellido: mbellido@g.hmc.edu
+// Integer-to-decimal formatting into a caller buffer. Division by the constant 10
+// compiles to a multiply and shift, so a full number costs tens of cycles instead
+// of a trip through printf's float machinery.
+
+#include "FORMAT.h"
+
+char * formatString(char * p, const char * s) {
+  while (*s) *p++ = *s++;
+  return p;
+}
+
+char * formatUint(char * p, uint32_t value) {
+  char digits[10]; // 4294967295 has 10 digits
+  int n = 0;
+
+  // Peel digits least significant first, then copy them out in reading order
+  do {
+    digits[n++] = '0' + (value % 10);
+    value /= 10;
+  } while (value);
+
+  while (n) *p++ = digits[--n];
+  return p;
+}
+
+char * formatMilli(char * p, uint32_t milli) {
+  uint32_t frac = milli % 1000;
+
+  p = formatUint(p, milli / 1000);
+  *p++ = '.';
+  *p++ = '0' + frac / 100;
+  *p++ = '0' + (frac / 10) % 10;
+  *p++ = '0' + frac % 10;
+  return p;
+}
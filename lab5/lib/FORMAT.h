@@ -0,0 +1,29 @@
+// FORMAT.h
+// Marina Bellido: mbellido@g.hmc.edu
+// Header for small integer-to-text helpers (no printf, no heap)
+
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+// Each function writes at p in a caller-owned buffer and returns the new end, so calls
+// chain: p = formatString(p, "x = "); p = formatUint(p, x); *p = 0;
+// Nothing is NUL-terminated and nothing is bounds-checked: size the buffer for the worst case.
+
+/* Copies a NUL-terminated string (without its NUL).
+ *    -- return: pointer just past the copied text */
+char * formatString(char * p, const char * s);
+
+/* Writes an unsigned decimal number (at most 10 digits).
+ *    -- return: pointer just past the last digit */
+char * formatUint(char * p, uint32_t value);
+
+/* Writes a fixed-point thousandths value as "<int>.<3 digits>", e.g. 1250 -> "1.250".
+ *    -- return: pointer just past the last digit */
+char * formatMilli(char * p, uint32_t milli);
+
+#endif
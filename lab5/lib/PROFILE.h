@@ -0,0 +1,66 @@
+// PROFILE.h
+// Marina Bellido: mbellido@g.hmc.edu
+// Header for lightweight cycle profiling: log2 histograms of region duration and
+// interrupt entry latency, timed with the Cortex-M4 DWT cycle counter.
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(__ARM_ARCH)
+#include <stm32l432xx.h>
+#define profileNow() (DWT->CYCCNT) // one load: cycles since profileInit()
+#else
+uint32_t profileNow(void);         // host build: clock_gettime() in nanoseconds
+#endif
+
+#define PROFILE_BUCKETS 32 // bucket b holds values in [2^(b-1), 2^b); bucket 0 holds 0
+
+// Probe ids, one duration + one latency histogram each (shared by every lab). Latency needs a
+// hardware timestamp of the event, so only PROFILE_CAPTURE records it (the captured edge in CCR1).
+// EXTI latches no time: by the first instruction of the handler, nothing tells how long the pending
+// bit has been set. (The TIM16 capture of the same PA6 edge ticks at 1 us = 80 cycles, coarser than
+// the 12-cycle entry itself, and reading its CCR1 from the EXTI handler would clear CC1IF before the
+// capture ISR sees it.)
+#define PROFILE_EXTI    0 // lab5: encoder EXTI handler (duration only)
+#define PROFILE_CAPTURE 1 // lab5: TIM16 capture/overflow ISR
+#define PROFILE_SAMPLER 2 // lab5: TIM6 sample window ISR
+#define PROFILE_SPI     3 // lab6: spiSendReceive()
+#define PROFILE_SEND    4 // lab6: sendString()
+#define PROFILE_MAX     5
+
+// Annotate a region:  uint32_t t0 = profileNow(); ... PROFILE_END(PROFILE_SPI, t0);
+#define PROFILE_END(id, t0) profileDuration((id), profileNow() - (t0))
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+/* Enables the DWT cycle counter (trace must be on for CYCCNT to run), measures what a probe
+ * itself costs (reported by profileDump()) and clears all histograms. */
+void profileInit(void);
+
+/* Clears all histograms. */
+void profileClear(void);
+
+/* Adds one region duration to a probe's histogram.
+ *    -- id: PROFILE_* probe id
+ *    -- cycles: profileNow() difference */
+void profileDuration(int id, uint32_t cycles);
+
+/* Adds one entry latency (event to first instruction of the handler) to a probe's histogram.
+ * The caller derives it from a hardware timestamp of the event, e.g. a timer capture.
+ *    -- cycles: latency in CPU cycles */
+void profileLatency(int id, uint32_t cycles);
+
+/* Formats the probe overhead, then every probe that has samples, and hands the text to write()
+ * one line at a time. The latency line is left out for probes that record none.
+ *    -- write: output function, e.g. a wrapper around sendString() */
+void profileDump(void (*write)(char * text));
+
+#endif
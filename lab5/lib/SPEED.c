@@ -0,0 +1,95 @@
+// SPEED.c
+// Marina Bellido: mbellido@g.hmc.edu
+// Speed estimation from the encoder. At high speed the count over a short window is
+// accurate (M-method); at low speed only a handful of edges land in a window, so the
+// time between hardware-captured edges is used instead (T-method).
+
+#include "SPEED.h"
+
+static volatile uint32_t overflows = 0; // capture timer wraps (65536 ticks each)
+static volatile uint32_t edgeTime0 = 0; // extended timestamp of the last captured edge
+static volatile uint32_t edgeTime1 = 0; // ... and of the edge before it
+static volatile uint32_t period    = 0; // ticks for one full channel A cycle, 0 = unknown
+static volatile uint8_t  edges     = 0; // captured edges since reset/timeout (saturates at 2)
+
+static volatile speedSample samples[2];   // double buffer: one current, one being written
+static volatile uint8_t  current   = 0; // index of the published half
+static volatile uint32_t published = 0; // windows published so far
+static uint32_t lastRead = 0;           // last window handed to speedRead()
+
+void speedCaptureReset(void) {
+  period = 0;
+  edges = 0;
+}
+
+void speedCaptureEdge(uint16_t ccr) {
+  uint32_t t = (overflows << 16) | ccr; // 32-bit timestamp
+
+  // Both edges of A are captured, so two captures back is one full cycle.
+  // Using a full cycle cancels any duty-cycle asymmetry of the encoder.
+  if (edges >= 2) period = t - edgeTime1;
+  else edges++;
+
+  edgeTime1 = edgeTime0;
+  edgeTime0 = t;
+}
+
+void speedCaptureOverflow(void) {
+  overflows++;
+
+  // Nothing captured for a long time: the last period no longer describes the shaft
+  if (((overflows << 16) - edgeTime0) > (uint32_t)(SPEED_TIMEOUT_US * (CAPTURE_TICK_HZ / 1000000))) {
+    period = 0;
+    edges = 0;
+  }
+}
+
+uint32_t speedCapturePeriod(void) {
+  return period;
+}
+
+void speedPublish(int32_t counts, uint32_t period) {
+  uint8_t next = current ^ 1;
+
+  samples[next].window = published + 1;
+  samples[next].counts = counts;
+  samples[next].period = period;
+
+  current = next;       // the reader switches halves with this single store
+  published = published + 1;
+}
+
+int speedRead(speedSample * sample) {
+  uint32_t seen;
+
+  // Copy the current half; if the sampler published again meanwhile, copy again.
+  // A window lasts milliseconds and the copy a few cycles, so this retries at most once.
+  do {
+    seen = published;
+    uint8_t i = current;
+    sample->window = samples[i].window;
+    sample->counts = samples[i].counts;
+    sample->period = samples[i].period;
+  } while (seen != published);
+
+  if (sample->window == lastRead) return 0;
+  lastRead = sample->window;
+  return 1;
+}
+
+uint32_t speedEstimate(int32_t counts, uint32_t period, uint32_t window_ms, int * method) {
+  uint32_t n = (counts < 0) ? -counts : counts;
+  uint32_t p = period;
+
+  if (n >= SPEED_MIN_EDGES || p == 0) {
+    // M-method: counts per second first, then per 1000 revolutions.
+    // Stays within 32 bits up to ~4.2 M counts/s (~2600 rotations/s).
+    *method = SPEED_M_METHOD;
+    uint32_t cps = (n * 1000) / window_ms;
+    return (cps * 1000) / COUNTS_PER_REV;
+  }
+
+  // T-method: CAPTURE_COUNTS counts took p ticks
+  *method = SPEED_T_METHOD;
+  return SPEED_T_MILLI / p;
+}
@@ -0,0 +1,72 @@
+// SPEED.h
+// Marina Bellido: mbellido@g.hmc.edu
+// Header for encoder speed estimation (M-method count per window / T-method edge period)
+
+#ifndef SPEED_H
+#define SPEED_H
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define COUNTS_PER_REV     1632    // 408 lines x 4 edges per line
+#define CAPTURE_TICK_HZ    1000000 // capture timer rate: 1 us timestamps
+#define CAPTURE_COUNTS     4       // one full channel A cycle (two captured edges) = 4 counts
+#define SPEED_MIN_EDGES    16      // fewer counts than this in a window -> use the edge period
+#define SPEED_TIMEOUT_US   250000  // no captured edge for this long -> shaft is stopped
+
+// T-method numerator: milli-rotations/s = SPEED_T_MILLI / period (evaluated at compile time)
+#define SPEED_T_MILLI ((uint32_t)((uint64_t)CAPTURE_COUNTS * CAPTURE_TICK_HZ * 1000 / COUNTS_PER_REV))
+
+// Which method produced the last estimate
+#define SPEED_M_METHOD 0 // counts per window (good at high speed)
+#define SPEED_T_METHOD 1 // time between edges (good at low speed)
+
+// One closed sample window, published by the sampler interrupt
+typedef struct {
+  uint32_t window; // window number since start-up
+  int32_t  counts; // net encoder counts in the window (CW positive)
+  uint32_t period; // captured channel A period in capture ticks, 0 if unknown
+} speedSample;
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+/* Forgets any captured period (call before enabling the capture interrupt). */
+void speedCaptureReset(void);
+
+/* Records a captured edge of channel A (call from the capture-compare interrupt).
+ *    -- ccr: 16-bit captured counter value */
+void speedCaptureEdge(uint16_t ccr);
+
+/* Extends the 16-bit capture timer (call from its update interrupt). Also times out
+ * the period once no edge has been seen for SPEED_TIMEOUT_US. */
+void speedCaptureOverflow(void);
+
+/* Returns the period of the last full channel A cycle in capture ticks, 0 if unknown */
+uint32_t speedCapturePeriod(void);
+
+/* Publishes a closed window (call from the sampler interrupt only).
+ * Written to the idle half of a double buffer, then made current with one index store.
+ *    -- counts: net encoder counts in the window
+ *    -- period: speedCapturePeriod() at the window boundary */
+void speedPublish(int32_t counts, uint32_t period);
+
+/* Copies the most recent window (main loop side).
+ *    -- sample: where to copy it
+ *    -- return: 1 if it is a window not read before, 0 otherwise */
+int speedRead(speedSample * sample);
+
+/* Estimates the speed for one sample window, picking the M- or T-method automatically.
+ * Integer only (two or one 32-bit divisions), so no float code is linked in.
+ *    -- counts: net encoder counts in the window (sign ignored)
+ *    -- period: captured channel A period in capture ticks, 0 if unknown
+ *    -- window_ms: window length in milliseconds
+ *    -- method: set to SPEED_M_METHOD or SPEED_T_METHOD
+ *    -- return: speed in milli-rotations/s (magnitude), e.g. 1250 = 1.250 rotations/s */
+uint32_t speedEstimate(int32_t counts, uint32_t period, uint32_t window_ms, int * method);
+
+#endif
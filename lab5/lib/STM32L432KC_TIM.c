@@ -17,11 +17,81 @@ void initTIM(TIM_TypeDef * TIMx){
 }
 
 void delay_millis(TIM_TypeDef * TIMx, uint32_t ms){
+  startTimeout(TIMx, ms);
+  while(!timeoutExpired(TIMx)); // Wait for UIF to go high
+}
+
+void startTimeout(TIM_TypeDef * TIMx, uint32_t ms){
   TIMx->ARR = ms;// Set timer max count
   TIMx->EGR |= 1;     // Force update
   TIMx->SR &= ~(0x1); // Clear UIF
   TIMx->CNT = 0;      // Reset count
+}
+
+int timeoutExpired(TIM_TypeDef * TIMx){
+  return TIMx->SR & 1; // UIF goes high when CNT wraps at ARR
+}
+
+
+void initEncoderTIM(TIM_TypeDef * TIMx, int reverse, uint32_t filter){
+  TIMx->CR1 &= ~TIM_CR1_CEN; // Stop the counter while it is reconfigured
+
+  TIMx->PSC = 0;      // Count every encoder edge (no prescaling)
+  TIMx->ARR = 0xFFFF; // Free-run over the full 16-bit range
+
+  // Map IC1 onto TI1 and IC2 onto TI2 (CC1S = CC2S = 01), same glitch filter on both channels
+  TIMx->CCMR1 &= ~(TIM_CCMR1_CC1S | TIM_CCMR1_CC2S | TIM_CCMR1_IC1F | TIM_CCMR1_IC2F);
+  TIMx->CCMR1 |= _VAL2FLD(TIM_CCMR1_CC1S, 0b01) | _VAL2FLD(TIM_CCMR1_CC2S, 0b01);
+  TIMx->CCMR1 |= _VAL2FLD(TIM_CCMR1_IC1F, filter) | _VAL2FLD(TIM_CCMR1_IC2F, filter);
+
+  // Non-inverted inputs; CCxNP must stay 0 in encoder mode
+  TIMx->CCER &= ~(TIM_CCER_CC1P | TIM_CCER_CC1NP | TIM_CCER_CC2P | TIM_CCER_CC2NP);
+  if (reverse) TIMx->CCER |= TIM_CCER_CC1P; // Inverting one channel reverses the count direction
+
+  // Encoder mode 3: count up/down on both TI1 and TI2 edges (x4 resolution)
+  TIMx->SMCR &= ~TIM_SMCR_SMS;
+  TIMx->SMCR |= _VAL2FLD(TIM_SMCR_SMS, 0b011);
+
+  TIMx->EGR |= TIM_EGR_UG;  // Load PSC/ARR and clear the counter
+  TIMx->CR1 |= TIM_CR1_CEN; // Enable counter
+}
+
+void initCaptureTIM(TIM_TypeDef * TIMx, uint32_t tick_hz, uint32_t filter){
+  TIMx->CR1 &= ~TIM_CR1_CEN; // Stop the counter while it is reconfigured
+
+  TIMx->PSC = (SystemCoreClock / tick_hz) - 1; // Timestamp resolution
+  TIMx->ARR = 0xFFFF;                          // Free-run; overflows are counted by the update interrupt
+
+  // IC1 mapped on TI1, no input prescaler (capture every edge), glitch filter as requested
+  TIMx->CCMR1 &= ~(TIM_CCMR1_CC1S | TIM_CCMR1_IC1PSC | TIM_CCMR1_IC1F);
+  TIMx->CCMR1 |= _VAL2FLD(TIM_CCMR1_CC1S, 0b01) | _VAL2FLD(TIM_CCMR1_IC1F, filter);
+
+  // CC1P = CC1NP = 1: capture on both rising and falling edges, then enable the capture
+  TIMx->CCER |= TIM_CCER_CC1P | TIM_CCER_CC1NP;
+  TIMx->CCER |= TIM_CCER_CC1E;
+
+  TIMx->CR1 |= TIM_CR1_URS; // Only counter overflow raises UIF, not the UG below
+  TIMx->EGR |= TIM_EGR_UG;  // Load PSC/ARR
+  TIMx->SR = 0;             // Start with no stale flags
 
-  while(!(TIMx->SR & 1)); // Wait for UIF to go high
+  TIMx->DIER |= TIM_DIER_CC1IE | TIM_DIER_UIE; // Interrupt on capture and on overflow
+  TIMx->CR1 |= TIM_CR1_CEN;                    // Enable counter
 }
 
+void initPeriodicTIM(TIM_TypeDef * TIMx, uint32_t ms){
+  TIMx->CR1 &= ~TIM_CR1_CEN; // Stop the counter while it is reconfigured
+
+  TIMx->PSC = (SystemCoreClock / 10000) - 1; // 10 kHz tick (fits the 16-bit PSC up to 655 MHz)
+  TIMx->ARR = (ms * 10) - 1;                 // One update event per period
+
+  TIMx->CR1 |= TIM_CR1_URS; // Only counter overflow raises UIF, not the UG below
+  TIMx->EGR |= TIM_EGR_UG;  // Load PSC/ARR and clear the counter
+  TIMx->SR = 0;             // Start with no stale flags
+
+  TIMx->DIER |= TIM_DIER_UIE; // Interrupt on every update event
+  TIMx->CR1 |= TIM_CR1_CEN;   // Enable counter
+}
+
+uint16_t readEncoderTIM(TIM_TypeDef * TIMx){
+  return (uint16_t) TIMx->CNT;
+}
@@ -8,6 +8,20 @@
 #include <stm32l432xx.h>
 #include "STM32L432KC_GPIO.h"
 
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+// ICxF input filter codes (CKD = 00, so fDTS = timer clock): a level must hold for N samples
+// before the edge is passed on, so shorter pulses never reach the counter or the capture.
+#define TIM_FILTER_OFF     0b0000
+#define TIM_FILTER_CK_N2   0b0001 // timer clock, N = 2
+#define TIM_FILTER_CK_N4   0b0010 // timer clock, N = 4
+#define TIM_FILTER_CK_N8   0b0011 // timer clock, N = 8
+#define TIM_FILTER_DTS2_N8 0b0101 // fDTS/2, N = 8 (16 clocks)
+#define TIM_FILTER_DTS4_N8 0b0111 // fDTS/4, N = 8 (32 clocks)
+#define TIM_FILTER_DTS8_N8 0b1001 // fDTS/8, N = 8 (64 clocks)
+
 ///////////////////////////////////////////////////////////////////////////////
 // Function prototypes
 ///////////////////////////////////////////////////////////////////////////////
@@ -16,5 +30,35 @@ void initTIM(TIM_TypeDef * TIMx);
 void delay_millis(TIM_TypeDef * TIMx, uint32_t ms);
 void delay_micros(TIM_TypeDef * TIMx, uint32_t us);
 
+/* Configures channel 1 of a timer as a free-running input capture on both edges of TI1,
+ * so every edge on the pin is timestamped in hardware.
+ *    -- tick_hz: counter rate, e.g. 1000000 for 1 us timestamps
+ *    -- filter: IC1F digital filter code (0 = off, see TIM_FILTER_* below)
+ * Enables the capture (CC1IE) and overflow (UIE) interrupts; the NVIC is left to the caller. */
+void initCaptureTIM(TIM_TypeDef * TIMx, uint32_t tick_hz, uint32_t filter);
+
+/* Starts a timer that raises its update interrupt (UIE) every ms milliseconds.
+ * Auto-reload restarts each period in hardware, so periods do not drift.
+ * Uses a 10 kHz tick: ms can go up to 6553. The NVIC is left to the caller. */
+void initPeriodicTIM(TIM_TypeDef * TIMx, uint32_t ms);
+
+/* Starts a one-shot window of ms milliseconds without blocking (initTIM() time base).
+ * Poll timeoutExpired() while doing other work; delay_millis() is start + wait. */
+void startTimeout(TIM_TypeDef * TIMx, uint32_t ms);
+
+/* Returns 1 once the window started by startTimeout() has elapsed, else 0 */
+int timeoutExpired(TIM_TypeDef * TIMx);
+
+/* Puts a timer in encoder interface mode 3 (SMS = 011) so the counter follows every
+ * edge of both quadrature channels in hardware, with no CPU work per edge.
+ *    -- TIMx: timer whose CH1/CH2 pins are wired to the encoder (pins set to AF by the caller)
+ *    -- reverse: 1 inverts TI1 polarity, which swaps the counting direction
+ *    -- filter: IC1F/IC2F digital filter code applied to both channels (0 = off) */
+void initEncoderTIM(TIM_TypeDef * TIMx, int reverse, uint32_t filter);
+
+/* Returns the encoder position held in the timer counter.
+ *    -- return: raw CNT value; subtract two samples as int16_t to get signed edges */
+uint16_t readEncoderTIM(TIM_TypeDef * TIMx);
+
 #endif
 
@@ -9,8 +9,9 @@
         - In which direction it’s rotating → by checking the phase relationship between A and B.
     This code:
         Configures the MCU’s GPIO pins and interrupt system to detect both rising and falling edges of both channels (A and B).
-        Every time a change happens, an interrupt fires → counts pulses and updates direction.
+        Every time a change happens, an interrupt fires → queues a timestamped A/B snapshot that the main loop decodes into a signed position (CW positive).
         Every second, prints the rotational speed (rotations/sec) and direction.
+        On request over USART2 ('p'), prints how long the interrupt handlers have been taking.
 */
 
 #include "main.h"
@@ -20,15 +21,24 @@
 #define CW 0 
 #define CCW 1
 
+// Output for profileDump()
+static void writeText(char * text) {
+    fputs(text, stdout);
+}
 
-volatile int counter = 0; // total encoder edges detected (A or B changes) -pulses.
-volatile double direction = 0;
-volatile bool pastAstate = 0, pastBstate = 0; // previous states of A and B so you can compare against new readings to find direction changes.
-        // Notes: volatile means these variables can change unexpectedly
-
+// Window bookkeeping, owned by TIM6_DAC_IRQHandler
+#if ENCODER_MODE == ENCODER_MODE_TIM
+static uint16_t lastCount = 0;   // encoder timer CNT at the previous window boundary
+#else
+static int enc = -1;             // id from encoderRegister()
+static int32_t lastPosition = 0; // decoded position at the previous window boundary
+#endif
 
  int main(void) {
 
+    // Start the DWT cycle counter: timestamps queued edges and times the ISRs (PROFILE.c)
+    profileInit();
+
     // Set up the physical pins so that the MCU can detect transitions from the encoder.
     // Enable inputs for encoder
     gpioEnable(GPIO_PORT_A); // Turns on the clock for GPIO Port A via RCC.
@@ -40,129 +50,180 @@ volatile bool pastAstate = 0, pastBstate = 0; // previous states of A and B so y
     GPIOA->PUPDR |= _VAL2FLD(GPIO_PUPDR_PUPD6, 0B10); // PULLDOWN P6
     GPIOA->PUPDR |= _VAL2FLD(GPIO_PUPDR_PUPD8, 0B10); // PULLDOWN P8
 
-    //Initialize timer: Enables the clock to TIM2 which sits on the APB1 bus
-    RCC->APB1ENR1 |= RCC_APB1ENR1_TIM2EN;
-    // Note: This must be done before you configure or use TIM2 registers — otherwise any write to TIM2 will be ignored.
-    initTIM(DELAY_TIM); 
-    // Enables Timer 2 and initializes it for delay functions.
-    // Used later to delay 1 second between speed calculations.
-    // Notes: initTIM() custom function, defined in another file. And DELAY TIM is a macro for TIM2
-
-
-    //Enables the clock for the SYSCFG (System Configuration) peripheral on the APB2 bus in RCC module.
-    RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN; // lets GPIO pins trigger interrupts through the EXTI system.
-    // Configure EXTICR for the encoder interrupts
-    SYSCFG->EXTICR[1] |= _VAL2FLD(SYSCFG_EXTICR2_EXTI6, 0b000); // Select PA6
-    SYSCFG->EXTICR[2] |= _VAL2FLD(SYSCFG_EXTICR3_EXTI8, 0b000); // Select PA8
-    // Notes: 0b00 -> is portA
-
-
-    // Enable interrupts globally:
+#if ENCODER_MODE == ENCODER_MODE_TIM
+    // Hand the encoder pins over to TIM1 so edges are counted without interrupts
+    pinMode(ENCODER_TIM_CH1, GPIO_ALT);
+    pinMode(ENCODER_TIM_CH2, GPIO_ALT);
+    GPIOA->AFR[1] |= _VAL2FLD(GPIO_AFRH_AFSEL8, 1) | _VAL2FLD(GPIO_AFRH_AFSEL9, 1); // AF1 -> TIM1_CH1/CH2
+    GPIOA->PUPDR |= _VAL2FLD(GPIO_PUPDR_PUPD9, 0B10); // PULLDOWN P9 (P8 done above)
+
+    RCC->APB2ENR |= RCC_APB2ENR_TIM1EN;
+    // TI1 is channel B and TI2 is channel A, so invert TI1 to make CW count up (same sense as checkDirection())
+    initEncoderTIM(ENCODER_TIM, 1, ENCODER_FILTER);
+    lastCount = readEncoderTIM(ENCODER_TIM);
+#else
+    // Register the encoder: encoderRegister() (ENCODER.c) sets the pins as pulled-down inputs,
+    // selects port A for EXTI6/EXTI8 in SYSCFG->EXTICR, enables rising and falling triggers and
+    // turns on EXTI9_5_IRQn in the NVIC. More axes are more encoderRegister() calls on other pin numbers.
+    enc = encoderRegister(ENCODER_A, ENCODER_B);
+    uint32_t lastOverflows = 0;
+    encoderStats stats, lastStats = {0, 0, 0};
+#endif
+
+    // Period (T-method) measurement: TIM16_CH1 shares PA6 with channel A and timestamps both of
+    // its edges in hardware. EXTI keeps working on PA6 while the pin is in AF mode.
+    pinMode(CAPTURE_PIN, GPIO_ALT);
+    GPIOA->AFR[0] |= _VAL2FLD(GPIO_AFRL_AFSEL6, 14); // AF14 -> TIM16_CH1
+    RCC->APB2ENR |= RCC_APB2ENR_TIM16EN;
+    speedCaptureReset();
+    initCaptureTIM(CAPTURE_TIM, CAPTURE_TICK_HZ, ENCODER_FILTER);
+    NVIC->ISER[0] |= (1 << TIM1_UP_TIM16_IRQn); // TIM16 capture and update share this vector with TIM1 update
+
+
+    //Initialize sampler: Enables the clock to TIM6 (basic timer) which sits on the APB1 bus
+    RCC->APB1ENR1 |= RCC_APB1ENR1_TIM6EN;
+    // Its update interrupt closes one window every SPEED_WINDOW_MS. The timer auto-reloads in hardware,
+    // so windows never drift no matter how long printf takes.
+    initPeriodicTIM(SAMPLE_TIM, SPEED_WINDOW_MS);
+    NVIC->IP[TIM6_DAC_IRQn] = (1 << 4); // Lower priority than the edge/capture interrupts so they can preempt it
+    NVIC->ISER[TIM6_DAC_IRQn >> 5] |= (1 << (TIM6_DAC_IRQn & 31));
+
+    // Command input (see main.h): polled, no interrupt
+    USART_TypeDef * commands = initUSART(COMMAND_USART_ID, COMMAND_BAUD);
+
+    // Enable interrupts globally, once every peripheral and priority above is set up
     __enable_irq();
 
 
-    EXTI->IMR1  |= (1 << gpioPinOffset(ENCODER_B)); // Configure the mask bit
-    EXTI->RTSR1 |= (1 << gpioPinOffset(ENCODER_B)); // Enable rising edge trigger
-    EXTI->FTSR1 |= (1 << gpioPinOffset(ENCODER_B)); // Enable falling edge trigger
-    EXTI->IMR1  |= (1 << gpioPinOffset(ENCODER_A)); // Interrupt Mask Register: EXTI6 on this pin to generate an interrupt
-    EXTI->RTSR1 |= (1 << gpioPinOffset(ENCODER_A)); // Rising Trigger Selection Register: Enable rising edge interrupt trigger 
-    EXTI->FTSR1 |= (1 << gpioPinOffset(ENCODER_A)); // Enable falling edge interrupt trigger
-    // The hardware now automatically triggers the ISR whenever the pin changes.
+    uint32_t speed = 0;       // milli-rotations/s
+    char line[128];           // telemetry line, built with FORMAT.c (no printf)
+    int direction = CW;
+    int method = SPEED_M_METHOD;
+    uint32_t lastPrinted = 0; // window number of the last printed line
+    uint32_t reversals = 0;   // direction changes seen since the last printed line
+    speedSample sample;
+    while(1){
+        // Nothing to do until the sampler publishes a window: sleep until the next interrupt
+        __WFI();
+
+        // A command typed since the last wake-up
+        if (commands->ISR & USART_ISR_RXNE) {
+            char command = readChar(commands);
+            commands->ICR = USART_ICR_ORECF; // more keys than one per window overrun: the first is kept
+            if (command == CMD_PROFILE_DUMP) {
+                fputs("\n", stdout);
+                profileDump(writeText);
+            } else if (command == CMD_PROFILE_CLEAR) {
+                profileClear();
+            }
+        }
+
+        if (!speedRead(&sample)) continue;
 
-    NVIC->ISER[0] |= (1 << EXTI9_5_IRQn); // Turn on EXTI interrupt in NVIC_ISER (Interrupt Set-Enable Register)
-    // tell the CPU’s interrupt controller to start accepting interrupts from a specific source. 
-    // EXTI9_5_IRQn covers pins 5, 6, 7, 8, 9 — both your encoder pins (PA6 and PA8) are in that range.
-        // the n at the end lets you change that for any other word -> so call it handler
+        if (sample.counts != 0) {
+            // at low speed a window may hold no edge: keep the last direction
+            int newDirection = (sample.counts < 0) ? CCW : CW;
+            if (newDirection != direction) reversals++;
+            direction = newDirection;
+        }
 
+        // Speed is refreshed every window: count per window when fast, captured edge period when slow
+        speed = speedEstimate(sample.counts, sample.period, SPEED_WINDOW_MS, &method);
 
+        // Print only every PRINT_EVERY windows
+        if (sample.window - lastPrinted < PRINT_EVERY) continue;
+        lastPrinted = sample.window;
 
-    float speed = 0.0;
-    while(1){
-        delay_millis(DELAY_TIM, 1000); // wait one second (sampling interval for speed measurement.)
-        
-        speed = (float)counter/1632; // 408*4
-      //printf("current direction: %f direction", direction);
-      printf("\nCurrent speed: %.3f rotations/s", speed);
-        if (speed != 0.0){
+        char * p = line;
+        p = formatString(p, "\nCurrent speed: ");
+        p = formatMilli(p, speed);
+        p = formatString(p, " rotations/s");
+        if (method == SPEED_T_METHOD) p = formatString(p, " (period)");
+        if (speed != 0){
             if (direction) {
-                printf(" : CCW direction");
+                p = formatString(p, " : CCW direction");
             } else {
-                printf(" : CW direction");
+                p = formatString(p, " : CW direction");
             } 
         } 
-        counter = 0; 
+#if ENCODER_MODE == ENCODER_MODE_EXTI
+        // Report edges the ISR had to drop because the queue was full
+        uint32_t overflows = encoderDropped();
+        if (overflows != lastOverflows) {
+            p = formatString(p, " (");
+            p = formatUint(p, overflows - lastOverflows);
+            p = formatString(p, " edges dropped)");
+        }
+        lastOverflows = overflows;
+
+        // Per-edge signal integrity since the last line: illegal transitions rising with speed mean
+        // edges are arriving faster than the ISR can sample them
+        encoderReadStats(enc, &stats);
+        p = formatString(p, " [illegal ");
+        p = formatUint(p, stats.illegal - lastStats.illegal);
+        p = formatString(p, ", double ");
+        p = formatUint(p, stats.doubles - lastStats.doubles);
+        p = formatString(p, ", reversals ");
+        p = formatUint(p, stats.reversals - lastStats.reversals);
+        p = formatString(p, "]");
+        lastStats = stats;
+#else
+        // The timer counts legal edges only and cannot report illegal ones; show window-level reversals
+        p = formatString(p, " [reversals ");
+        p = formatUint(p, reversals);
+        p = formatString(p, "]");
+#endif
+        reversals = 0;
+        *p = 0;
+        fputs(line, stdout);
     }
 }
 
-    // Detecting motor’s rotation direction from the quadrature encoder signals 
-    // by comparing the previous state with the new state:
-    void checkDirection(bool newAstate, bool newBstate){
-    // Quadrature encoder logic has 4 states: (A,B) = 00, 01, 10, 11. Check all 4 previous states
-    if (!pastAstate && !pastBstate) {
-        if (newAstate && !newBstate) direction = CW;
-         else if (!newAstate && newBstate) direction = CCW;
-    } 
-    else if (!pastAstate && pastBstate) {
-        if (!newAstate && !newBstate) direction = CW;
-         else if (newAstate && newBstate) direction = CCW;
-    }
-    else if (pastAstate && !pastBstate) {
-        if (newAstate && newBstate) direction = CW;
-         else if (!newAstate && !newBstate) direction = CCW;
-    }
-    else if (pastAstate && pastBstate) {
-        if (!newAstate && newBstate) direction = CW;
-         else if (newAstate && !newBstate) direction = CCW;
-    }
-    pastAstate = newAstate;
-    pastBstate = newBstate;
-} 
-
-
-
-// Interrupt Service Routine (ISR) for handling external interrupts from a quadrature encoder
-//      ISR is called whenever either encoder channel A or B changes state (pins).
-//      You never call it directly: The hardware calls it automatically when the corresponding EXTI 
-//                                  pin detects an edge (rising or falling) that you have enabled.
-// Mention what variables can't be touched bc already used by handler like counter and newAstate
-
-//void EXTI6_IRQHandler(){ 
-void EXTI9_5_IRQHandler(void){
-    bool newAstate = 0, newBstate = 0;
-    // Place current states of encoder channels A and B into local variables.
-     newAstate = digitalRead(ENCODER_A);
-     newBstate = digitalRead(ENCODER_B);
-
-    // Check that encoder A was what triggered the interrupt
-    if (EXTI->PR1 &  (1 << ENCODER_A_NUM)){
-        EXTI->PR1 |= (1 << ENCODER_A_NUM); // Clearing the interrupt to Pending Register (PR1)
-
-        // rising edge: Increment the counter for every edge (rising or falling) on channel A.
-        if (digitalRead(ENCODER_A)){
-            counter ++;
-            newAstate = 1;
-        }
-        else { // falling edge
-            counter ++;
-            newAstate = 0;
-        }
-        checkDirection(newAstate, newBstate);
-        
-        //counter++;
-    } else if (EXTI->PR1 & (1 << ENCODER_B_NUM)) {
-        EXTI->PR1 |= (1 << ENCODER_B_NUM); // Clearing the interrupt to Pending Register (PR1)
-        
-        // incrementing the counter;
-        // rising edge
-        if (digitalRead(ENCODER_B)){
-            counter ++;
-            newBstate = 1;
-        }
-        else { // falling edge
-            counter ++;
-            newBstate = 0;
-        }
-        checkDirection(newAstate, newBstate); 
-    
-}}
+// Interrupt Service Routine for TIM6: closes one sample window
+//      Snapshots the encoder count accumulated since the previous window and publishes it,
+//      together with the latest captured period, through the double-buffered speedSample in SPEED.c.
+void TIM6_DAC_IRQHandler(void){
+    uint32_t t0 = profileNow();
+    SAMPLE_TIM->SR = ~TIM_SR_UIF; // rc_w0: clear UIF
+    int32_t counts;
+
+#if ENCODER_MODE == ENCODER_MODE_TIM
+    // The hardware counter never stops: the signed difference is the window's count (16-bit wrap is harmless)
+    uint16_t count = readEncoderTIM(ENCODER_TIM);
+    counts = (int16_t)(count - lastCount);
+    lastCount = count;
+#else
+    // This ISR is the edge queue's only consumer: decode everything up to the window boundary
+    encoderProcess();
+    int32_t position = encoderPosition(enc);
+    counts = position - lastPosition;
+    lastPosition = position;
+#endif
+
+    speedPublish(counts, speedCapturePeriod());
+    PROFILE_END(PROFILE_SAMPLER, t0);
+}
 
+// Interrupt Service Routine for TIM16 (shared vector with TIM1 update, unused here)
+//      CC1IF: an edge of channel A was captured -> hand the 16-bit timestamp to SPEED.c
+//      UIF:   the 16-bit counter wrapped -> extend the timestamp and time out a stopped shaft
+void TIM1_UP_TIM16_IRQHandler(void){
+    uint32_t t0 = profileNow();
+    uint16_t now = CAPTURE_TIM->CNT;
+    uint32_t sr = CAPTURE_TIM->SR;
+    uint16_t ccr = CAPTURE_TIM->CCR1; // reading CCR1 also clears CC1IF
+
+    // Entry latency: the edge was stamped in hardware, so the counter has moved on by exactly that much
+    if (sr & TIM_SR_CC1IF) profileLatency(PROFILE_CAPTURE, (uint16_t)(now - ccr) * (SystemCoreClock / CAPTURE_TICK_HZ));
+    CAPTURE_TIM->SR = ~(sr & TIM_SR_UIF); // rc_w0: clear only the update flag we are about to handle
+
+    // When both are pending, a small capture value means it was taken after the wrap
+    if ((sr & TIM_SR_UIF) && (sr & TIM_SR_CC1IF) && ccr < 0x8000) {
+        speedCaptureOverflow();
+        speedCaptureEdge(ccr);
+    } else {
+        if (sr & TIM_SR_CC1IF) speedCaptureEdge(ccr);
+        if (sr & TIM_SR_UIF) speedCaptureOverflow();
+    }
+    PROFILE_END(PROFILE_CAPTURE, t0);
+}
@@ -9,6 +9,12 @@
 #define MAIN_H
 
 #include "STM32L432KC.h"
+#include "ENCODER.h"
+#include "EDGE_QUEUE.h"
+#include "SPEED.h"
+#include "FORMAT.h"
+#include "PROFILE.h"
+#include "STM32L432KC_USART.h"
 #include <stm32l432xx.h>
 #include <stdio.h>
 #include <stdbool.h>
@@ -19,9 +25,40 @@
 
 #define ENCODER_A_NUM 6 
 #define ENCODER_B_NUM 8 
+#define ENCODER_EXTI_MASK ((1 << ENCODER_A_NUM) | (1 << ENCODER_B_NUM)) // EXTI lines used by the encoder
 
 #define ENCODER_A PA6
 #define ENCODER_B PA8
-#define DELAY_TIM TIM2
+#define SAMPLE_TIM TIM6 // update interrupt closes each speed sample window
+
+// How encoder edges are decoded:
+//    ENCODER_MODE_EXTI -> one EXTI interrupt per A/B edge (PA6/PA8): the lab board as wired
+//    ENCODER_MODE_TIM  -> TIM1 encoder interface counts edges in hardware, no interrupt per edge.
+//                         Needs a board change: jumper PA6 (channel A) to PA9, so TIM1 sees A on CH2
+//                         and B on CH1 (PA8). Counts the same as checkDirection() did (host/ENCODER_TIM_CHECK.c).
+#define ENCODER_MODE_EXTI 0
+#define ENCODER_MODE_TIM  1
+#define ENCODER_MODE ENCODER_MODE_EXTI
+
+#define ENCODER_TIM TIM1
+#define ENCODER_TIM_CH1 PA8 // TIM1_CH1 (AF1): encoder channel B, same wire as ENCODER_B
+#define ENCODER_TIM_CH2 PA9 // TIM1_CH2 (AF1): encoder channel A, jumpered from PA6 (keep PA6 wired for CAPTURE_PIN)
+
+// Input glitch filter on the encoder and capture timers: 8 samples at 4 MHz rejects pulses under 2 us
+// (full speed is well under 100 kedges/s, i.e. 10 us between edges). EXTI edges are not filtered.
+#define ENCODER_FILTER TIM_FILTER_CK_N8
+
+// Speed measurement
+#define CAPTURE_TIM TIM16   // input capture timer for the T-method (edge period)
+#define CAPTURE_PIN PA6     // TIM16_CH1 (AF14): same pin as ENCODER_A
+#define SPEED_WINDOW_MS 10  // sample window, speed is re-estimated every window
+#define PRINT_EVERY 100     // windows per printed line (1 s)
+
+// Commands, one character each, typed on the Nucleo's virtual COM port (USART2: PA2 TX, PA15 RX).
+// Polled once per window, so a command is answered within SPEED_WINDOW_MS.
+#define COMMAND_USART_ID  USART2_ID
+#define COMMAND_BAUD      115200
+#define CMD_PROFILE_DUMP  'p' // print the ISR timing histograms
+#define CMD_PROFILE_CLEAR 'c' // start them over
 
 #endif // MAIN_H
\ No newline at end of file
@@ -0,0 +1,138 @@
+// PROFILE.c
+// Marina Bellido: mbellido@g.hmc.edu
+// Fixed-size log2 histograms for ISR/region timing. A probe costs one CYCCNT load at
+// the start and, at the end, a subtraction, a CLZ and two increments; profileInit() times
+// that on the target and profileDump() prints it first. Nothing is formatted until
+// profileDump() is asked for.
+
+#include "PROFILE.h"
+#include "FORMAT.h"
+
+#if !defined(__ARM_ARCH)
+#include <time.h>
+#endif
+
+static const char * const names[PROFILE_MAX] = {
+  "EXTI", "CAPTURE", "SAMPLER", "SPI", "SEND"
+};
+
+static volatile uint32_t count[PROFILE_MAX];     // durations recorded
+static volatile uint32_t maxCycles[PROFILE_MAX]; // longest duration seen
+static volatile uint32_t duration[PROFILE_MAX][PROFILE_BUCKETS];
+static volatile uint32_t latency[PROFILE_MAX][PROFILE_BUCKETS];
+static uint32_t overhead; // cycles a probe adds to the code it wraps, measured by profileInit()
+static uint32_t inside;   // part of overhead counted in every duration (two back-to-back loads)
+
+#if !defined(__ARM_ARCH)
+uint32_t profileNow(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)(ts.tv_sec * 1000000000ull + ts.tv_nsec);
+}
+#endif
+
+// log2 bucket: number of significant bits, capped to the last bucket
+static int bucket(uint32_t value) {
+  if (value == 0) return 0;
+  int b = 32 - __builtin_clz(value); // single CLZ instruction on the M4
+  return (b < PROFILE_BUCKETS) ? b : PROFILE_BUCKETS - 1;
+}
+
+void profileInit(void) {
+#if defined(__ARM_ARCH)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // Enable the trace block (DWT)
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;            // Start the cycle counter
+#endif
+
+  // Time an empty region, then a whole probe around nothing. Both figures come from the try with
+  // the shortest probe span, so the part in each duration can never exceed the whole.
+  uint32_t best = UINT32_MAX;
+  for (int i = 0; i < 8; i++) {
+    uint32_t t0 = profileNow();
+    uint32_t empty = profileNow() - t0;
+    uint32_t t1 = profileNow();
+    uint32_t start = profileNow();
+    PROFILE_END(PROFILE_EXTI, start);
+    uint32_t span = profileNow() - t1; // the probe plus one back-to-back pair of loads
+    if (span >= best) continue;
+    best = span;
+    overhead = (span > empty) ? span - empty : 0; // a host clock can jitter the empty pair longer
+    inside = (empty < overhead) ? empty : overhead;
+  }
+  profileClear();
+}
+
+void profileClear(void) {
+  for (int id = 0; id < PROFILE_MAX; id++) {
+    count[id] = 0;
+    maxCycles[id] = 0;
+    for (int b = 0; b < PROFILE_BUCKETS; b++) {
+      duration[id][b] = 0;
+      latency[id][b] = 0;
+    }
+  }
+}
+
+void profileDuration(int id, uint32_t cycles) {
+  duration[id][bucket(cycles)]++;
+  count[id]++;
+  if (cycles > maxCycles[id]) maxCycles[id] = cycles;
+}
+
+void profileLatency(int id, uint32_t cycles) {
+  latency[id][bucket(cycles)]++;
+}
+
+// Appends " <2^b:n" for every non-empty bucket
+static char * formatHistogram(char * p, volatile uint32_t * hist) {
+  for (int b = 0; b < PROFILE_BUCKETS; b++) {
+    if (hist[b] == 0) continue;
+    p = formatString(p, " <2^");
+    p = formatUint(p, b);
+    *p++ = ':';
+    p = formatUint(p, hist[b]);
+  }
+  return p;
+}
+
+void profileDump(void (*write)(char * text)) {
+  // Longest line: 32 buckets x " <2^31:4294967295" (17 chars) plus the label
+  char line[PROFILE_BUCKETS * 17 + 16];
+
+  char * p = line;
+  p = formatString(p, "probe overhead=");
+  p = formatUint(p, overhead);
+  p = formatString(p, " (");
+  p = formatUint(p, inside);
+  p = formatString(p, " of it in each duration)\n");
+  *p = 0;
+  write(line);
+
+  for (int id = 0; id < PROFILE_MAX; id++) {
+    if (count[id] == 0) continue;
+
+    p = line;
+    p = formatString(p, names[id]);
+    p = formatString(p, ": n=");
+    p = formatUint(p, count[id]);
+    p = formatString(p, " max=");
+    p = formatUint(p, maxCycles[id]);
+    p = formatString(p, "\n");
+    *p = 0;
+    write(line);
+
+    p = formatHistogram(formatString(line, "  duration"), duration[id]);
+    p = formatString(p, "\n");
+    *p = 0;
+    write(line);
+
+    int latencies = 0;
+    for (int b = 0; b < PROFILE_BUCKETS; b++) if (latency[id][b]) latencies = 1;
+    if (!latencies) continue;
+    p = formatHistogram(formatString(line, "  latency "), latency[id]);
+    p = formatString(p, "\n");
+    *p = 0;
+    write(line);
+  }
+}
@@ -5,6 +5,7 @@
 #include "STM32L432KC_USART.h"
 #include "STM32L432KC_GPIO.h"
 #include "STM32L432KC_RCC.h"
+#include "PROFILE.h"
 
 USART_TypeDef * id2Port(int USART_ID) {
     USART_TypeDef * USART;
@@ -77,6 +78,7 @@ void sendChar(USART_TypeDef * USART, char data){
 }
 
 void sendString(USART_TypeDef * USART, char * charArray){
+    uint32_t t0 = profileNow(); // start of the PROFILE_SEND region
 
     uint32_t i = 0;
     do{
@@ -84,6 +86,7 @@ void sendString(USART_TypeDef * USART, char * charArray){
         i++;
     }
     while(charArray[i] != 0);
+    PROFILE_END(PROFILE_SEND, t0);
 }
 
 char readChar(USART_TypeDef * USART) {
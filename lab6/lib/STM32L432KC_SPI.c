@@ -6,6 +6,7 @@
 // SPI initialization and data transfer (STM32L432KC)
 
 #include "STM32L432KC_SPI.h"
+#include "PROFILE.h"
 
 void initSPI(int br, int cpol, int cpha) {  
     // br   = baud rate prescaler (0–7 → ÷2...÷256)
@@ -48,11 +49,13 @@ void initSPI(int br, int cpol, int cpha) {
 
 
 char spiSendReceive(char send) {   
+    uint32_t t0 = profileNow();                // start of the PROFILE_SPI region
     // send and receive one byte through SPI
     while (!(SPI1->SR & SPI_SR_TXE));          // wait for TX ready
     *((volatile char *)&SPI1->DR) = send;      // write byte to data register
     while (!(SPI1->SR & SPI_SR_RXNE));         // wait for received data
     volatile char rx = (volatile char) SPI1->DR; // read received byte
+    PROFILE_END(PROFILE_SPI, t0);              // record how long the transfer took
     return rx;                                 // return it
 }
 
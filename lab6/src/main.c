@@ -30,8 +30,17 @@ char* resStr = "<p><h2>Resolution Control:</h2></p><form action=\"12bit\"><input
         <form action=\"9bit\"><input type=\"submit\" value=\"9-bit resolution\"></form>\
         <form action=\"8bit\"><input type=\"submit\" value=\"8-bit resolution\"></form>";
 
+char* profileStr = "<p><h2>Timing:</h2></p><form action=\"profile\"><input type=\"submit\" value=\"Show SPI/USART timing\"></form>";
+
 char* webpageEnd   = "</body></html>";
 
+// USART used by sendProfileText() when the timing histograms are dumped into the page
+USART_TypeDef * profileUSART;
+
+void sendProfileText(char * text) {
+	sendString(profileUSART, text);
+}
+
 //determines whether a given character sequence is in a char array request, returning 1 if present, -1 if not present
 int inString(char request[], char des[]) {
 	if (strstr(request, des) != NULL) {return 1;}
@@ -115,6 +124,7 @@ void configurePins()
 int main(void) {
   configureFlash();
   configureClock();
+  profileInit(); // DWT cycle counter for the spiSendReceive()/sendString() timing histograms
 
   gpioEnable(GPIO_PORT_A);
   gpioEnable(GPIO_PORT_B);
@@ -131,6 +141,7 @@ int main(void) {
   configurePins();
   
   USART_TypeDef * USART = initUSART(USART1_ID, 125000);
+  profileUSART = USART;
 
   //TO DO: Add SPI initialization code -> DONE
   initSPI(0b111, 0, 1); 
@@ -192,6 +203,13 @@ int main(void) {
     sendString(USART, ledStatusStr);
     sendString(USART, "</p>");
 
+    // Timing histograms (cycles, log2 buckets) only when asked for
+    sendString(USART, profileStr);
+    if (inString(request, "profile") == 1) {
+      sendString(USART, "<pre>");
+      profileDump(sendProfileText);
+      sendString(USART, "</pre>");
+    }
 
 
     sendString(USART, webpageEnd);
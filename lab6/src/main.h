@@ -10,6 +10,7 @@
 
 #include "STM32L432KC.h"
 #include "DS1722.h"
+#include "PROFILE.h"
 
 #define LED_PIN PA6 // LED pin for blinking on Port B pin 3
 #define BUFF_LEN 32